@@ -0,0 +1,167 @@
+// проверка защиты файла настроек от отключения питания во время записи: новая версия пишется
+// в свободный слот, запись обрывается на каждом байте, и при выборе слота должна находиться
+// предыдущая версия; запуск - make -C extras/tests
+
+#include <stdio.h>
+#include <string>
+#include "srConfigSlots.h"
+
+// содержимое слота в памяти вместо файла
+struct SlotReader
+{
+  const std::string &data;
+  size_t pos;
+
+  SlotReader(const std::string &_data) : data(_data), pos(0) {}
+  int peek() { return ((pos < data.size()) ? (uint8_t)data[pos] : -1); }
+  int read() { return ((pos < data.size()) ? (uint8_t)data[pos++] : -1); }
+};
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+// слот в том виде, в каком его записывает save_config_file()
+static std::string make_slot(uint32_t seq, const std::string &json)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < json.size(); i++)
+  {
+    crc = sr_crc32_update(crc, json[i]);
+  }
+  char header[CONFIG_HEADER_SIZE];
+  sr_get_config_header(header, seq, ~crc, json.size());
+
+  return (std::string(header) + json);
+}
+
+static bool check_slot(const std::string &data, uint32_t &seq, size_t &offset)
+{
+  SlotReader in(data);
+  return (sr_check_config_slot(in, data.size(), seq, offset));
+}
+
+// выбор слота так же, как в find_config_slot()
+static int8_t select_slot(const std::string *slots, uint32_t *seq, size_t *offset)
+{
+  bool valid[CONFIG_SLOT_COUNT];
+  for (uint8_t i = 0; i < CONFIG_SLOT_COUNT; i++)
+  {
+    valid[i] = check_slot(slots[i], seq[i], offset[i]);
+  }
+
+  return (sr_select_config_slot(valid, seq));
+}
+
+static void test_complete_slot()
+{
+  std::string json = "{\"module\":\"test\",\"relays\":[{\"name\":\"lamp\",\"descr\":\"\"}]}";
+  std::string slot = make_slot(7, json);
+  uint32_t seq = 0;
+  size_t offset = 0;
+  CHECK(check_slot(slot, seq, offset));
+  CHECK(seq == 7);
+  CHECK(slot.substr(offset) == json);
+}
+
+static void test_power_cut_at_every_offset()
+{
+  std::string old_json = "{\"module\":\"old\",\"relays\":[{\"name\":\"lamp\",\"descr\":\"old\"}]}";
+  std::string new_json = "{\"module\":\"new\",\"relays\":[{\"name\":\"lamp\",\"descr\":\"new version\"}]}";
+
+  // версия 5 лежит в слоте A, версия 6 пишется в слот B и обрывается
+  std::string full = make_slot(6, new_json);
+  for (size_t cut = 0; cut < full.size(); cut++)
+  {
+    std::string slots[CONFIG_SLOT_COUNT] = {make_slot(5, old_json), full.substr(0, cut)};
+    uint32_t seq[CONFIG_SLOT_COUNT];
+    size_t offset[CONFIG_SLOT_COUNT];
+    int8_t slot = select_slot(slots, seq, offset);
+    CHECK(slot == 0);
+    if (slot == 0)
+    {
+      CHECK(seq[0] == 5);
+      CHECK(slots[0].substr(offset[0]) == old_json);
+    }
+  }
+
+  // запись завершена - выбирается новая версия
+  std::string slots[CONFIG_SLOT_COUNT] = {make_slot(5, old_json), full};
+  uint32_t seq[CONFIG_SLOT_COUNT];
+  size_t offset[CONFIG_SLOT_COUNT];
+  CHECK(select_slot(slots, seq, offset) == 1);
+  CHECK(seq[1] == 6);
+}
+
+static void test_power_cut_over_newest_slot()
+{
+  // следующая версия пишется поверх слота A, слот B с последней версией не трогается
+  std::string full = make_slot(7, "{\"module\":\"seven\",\"relays\":[]}");
+  for (size_t cut = 0; cut < full.size(); cut++)
+  {
+    std::string slots[CONFIG_SLOT_COUNT] = {full.substr(0, cut), make_slot(6, "{\"module\":\"six\",\"relays\":[]}")};
+    uint32_t seq[CONFIG_SLOT_COUNT];
+    size_t offset[CONFIG_SLOT_COUNT];
+    CHECK(select_slot(slots, seq, offset) == 1);
+  }
+}
+
+static void test_corrupted_byte()
+{
+  // порча любого байта слота обнаруживается по заголовку, длине или контрольной сумме
+  std::string full = make_slot(3, "{\"module\":\"test\",\"relays\":[]}");
+  for (size_t i = 0; i < full.size(); i++)
+  {
+    std::string slot = full;
+    slot[i] ^= 0x01;
+    uint32_t seq = 0;
+    size_t offset = 0;
+    // заголовок с измененным номером версии ("#sr 3" -> "#sr 2") остается корректным, остальное - нет
+    if (i != 4)
+    {
+      CHECK(!check_slot(slot, seq, offset));
+    }
+  }
+}
+
+static void test_sequence_wrap()
+{
+  bool valid[CONFIG_SLOT_COUNT] = {true, true};
+  uint32_t seq[CONFIG_SLOT_COUNT] = {0xFFFFFFFF, 0};
+  CHECK(sr_select_config_slot(valid, seq) == 1);
+
+  valid[1] = false;
+  CHECK(sr_select_config_slot(valid, seq) == 0);
+
+  valid[0] = false;
+  CHECK(sr_select_config_slot(valid, seq) == -1);
+}
+
+static void test_legacy_file()
+{
+  // старый файл настроек без заголовка принимается с номером версии 0
+  std::string legacy = "{\"module\":\"legacy\",\"relays\":[]}";
+  std::string slots[CONFIG_SLOT_COUNT] = {legacy, ""};
+  uint32_t seq[CONFIG_SLOT_COUNT];
+  size_t offset[CONFIG_SLOT_COUNT];
+  CHECK(select_slot(slots, seq, offset) == 0);
+  CHECK(seq[0] == 0 && offset[0] == 0);
+}
+
+int main()
+{
+  test_complete_slot();
+  test_power_cut_at_every_offset();
+  test_power_cut_over_newest_slot();
+  test_corrupted_byte();
+  test_sequence_wrap();
+  test_legacy_file();
+
+  printf("config_slot_test: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,27 @@
+// драйвер выходов для тестов: каждый перенос уровней на выходы записывается; commit() сам
+// изменения не отслеживает, поэтому каждый его вызов - отдельная запись
+#pragma once
+#include <vector>
+#include "srRelayDrivers.h"
+
+class srMockRelayDriver : public srRelayDriver
+{
+public:
+  uint8_t levels[SR_MAX_DRIVER_CHANNELS / 8] = {0};
+  std::vector<uint64_t> writes; // состояние всех каналов при каждой записи
+
+  void setChannel(uint8_t _channel, bool _level)
+  {
+    uint8_t bit = 1 << (_channel & 7);
+    (_level) ? levels[_channel >> 3] |= bit : levels[_channel >> 3] &= ~bit;
+  }
+
+  void commit()
+  {
+    uint64_t value = 0;
+    memcpy(&value, levels, sizeof(levels));
+    writes.push_back(value);
+  }
+
+  uint8_t getChannelCount() { return (SR_MAX_DRIVER_CHANNELS); }
+};
@@ -0,0 +1,131 @@
+// зависимость стоимости поиска реле по имени от размера таблицы: поиск через индекс имен
+// (getRelayHandle() у модулей реле и выключателя и поиск только по хэшу, как для команд без
+// имени) против прежнего перебора таблицы со сравнением строк; результаты поиска обоими способами
+// должны совпадать;
+// запуск - make -C extras/tests
+
+#include <stdio.h>
+#include <chrono>
+#include "shSRControl.cpp"
+#include "mock_relay_driver.h"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+// число поисков на каждый размер таблицы
+static const uint32_t lookup_count = 100000;
+
+// среднее время одного вызова _fn(i) при _count вызовах, нс
+template <typename F>
+static double measure_ns(uint32_t _count, F _fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < _count; i++)
+  {
+    _fn(i);
+  }
+  std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+  return (time.count() / _count);
+}
+
+// поиск перебором, как это делалось до индекса имен
+template <typename T>
+static int16_t find_by_scan(T &_table, uint16_t _count, const String &_name)
+{
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    if (_table[i].relayName == _name)
+    {
+      return (i);
+    }
+  }
+  return (-1);
+}
+
+struct srLookupResult
+{
+  double scan_ns;
+  double name_ns;
+  double hash_ns;
+};
+
+// ищутся по очереди все реле таблицы и каждое восьмое имя - отсутствующее в таблице
+template <typename M, typename T>
+static srLookupResult bench_lookup(M &_module, ModuleType _mdt, T &_table, uint16_t _count)
+{
+  std::vector<String> names;
+  std::vector<uint32_t> hashes;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    names.push_back((i % 8 == 7) ? "missing_" + String(i) : "relay_" + String(i));
+    hashes.push_back(get_name_hash(names[i].c_str()));
+  }
+
+  bool same = true;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    int16_t index = find_by_scan(_table, _count, names[i]);
+    same &= index == ((i % 8 == 7) ? -1 : i) &&
+            _module.getRelayHandle(names[i].c_str()) == index &&
+            find_in_name_index(_mdt, hashes[i], NULL) == index;
+  }
+  CHECK(same);
+
+  srLookupResult result;
+  volatile int32_t sum = 0;
+  result.scan_ns = measure_ns(lookup_count, [&](uint32_t i)
+                              { sum += find_by_scan(_table, _count, names[i % _count]); });
+  result.name_ns = measure_ns(lookup_count, [&](uint32_t i)
+                              { sum += _module.getRelayHandle(names[i % _count].c_str()); });
+  result.hash_ns = measure_ns(lookup_count, [&](uint32_t i)
+                              { sum += find_in_name_index(_mdt, hashes[i % _count], NULL); });
+  return (result);
+}
+
+static void bench_table_size(uint16_t _count)
+{
+  std::vector<srMockRelayDriver> drivers(_count / SR_MAX_DRIVER_CHANNELS + 1);
+  shRelayControl relays;
+  relays.init(0);
+  relays.setLogOnState(false);
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    relays.addRelay("relay_" + String(i), i % SR_MAX_DRIVER_CHANNELS, HIGH, nullptr, "",
+                    &drivers[i / SR_MAX_DRIVER_CHANNELS]);
+  }
+  CHECK(ctx->relayCount == _count);
+  srLookupResult relay = bench_lookup(relays, mtRelay, ctx->relayArray, _count);
+
+  shSwitchControl switches;
+  switches.init(0);
+  switches.setLogOnState(false);
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    switches.addRelay("relay_" + String(i), nullptr);
+  }
+  CHECK(ctx->switchCount == _count);
+  srLookupResult sw = bench_lookup(switches, mtSwitch, ctx->switchArray, _count);
+
+  printf("%6u %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+         _count, relay.scan_ns, relay.name_ns, relay.hash_ns, sw.scan_ns, sw.name_ns, sw.hash_ns);
+}
+
+int main()
+{
+  printf("                 relay, ns                    switch, ns\n");
+  printf("relays      scan      name      hash      scan      name      hash\n");
+  const uint16_t sizes[] = {8, 32, 64, 128, 256, SR_MAX_RELAY_COUNT};
+  for (uint16_t count : sizes)
+  {
+    bench_table_size(count);
+  }
+
+  printf("name_lookup_bench: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,113 @@
+// отправка UDP-пакетов не должна выделять память в куче: глобальные operator new/delete
+// заменены счетчиком, и через get_json_packet_to_send(), send_response() и send_udp_packet()
+// отправляются все виды исходящих пакетов - поиск, команда, ответы в JSON и в двоичном виде;
+// запуск - make -C extras/tests
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include "shSRControl.cpp"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+static uint32_t allocations = 0;
+
+void *operator new(size_t _size)
+{
+  allocations++;
+  void *result = malloc((_size) ? _size : 1);
+  if (!result)
+  {
+    throw std::bad_alloc();
+  }
+  return (result);
+}
+void *operator new[](size_t _size) { return (operator new(_size)); }
+void operator delete(void *_ptr) noexcept { free(_ptr); }
+void operator delete[](void *_ptr) noexcept { free(_ptr); }
+void operator delete(void *_ptr, size_t) noexcept { free(_ptr); }
+void operator delete[](void *_ptr, size_t) noexcept { free(_ptr); }
+
+// число пакетов каждого вида
+static const uint32_t packet_count = 1000;
+
+// отправляет _count пакетов через _fn и возвращает число выделений памяти на них
+template <typename F>
+static uint32_t count_allocations(WiFiUDP &_udp, F _fn)
+{
+  uint32_t sent = _udp.tx_count;
+  uint32_t start = allocations;
+  for (uint32_t i = 0; i < packet_count; i++)
+  {
+    _fn();
+  }
+  uint32_t result = allocations - start;
+  CHECK(_udp.tx_count - sent == packet_count);
+  return (result);
+}
+
+static bool tx_contains(WiFiUDP &_udp, const char *_str)
+{
+  std::string packet((const char *)_udp.tx, _udp.tx_len);
+  return (packet.find(_str) != std::string::npos);
+}
+
+int main()
+{
+  WiFiUDP udp;
+  shRelayControl relays;
+  relays.init(1);
+  relays.setLogOnState(false);
+  relays.addRelay("kitchen", 5, HIGH, nullptr, "kitchen light");
+  relays.startDevice(&udp, 4210);
+
+  String name = "kitchen";
+  String descr = "kitchen light";
+  IPAddress address(192, 168, 1, 20);
+
+  // счетчик действительно видит выделения памяти
+  uint32_t start = allocations;
+  String probe = name + descr;
+  CHECK(allocations > start);
+
+  // поиск всех реле
+  uint32_t n = count_allocations(udp, [&]()
+                                 { send_udp_packet(address, packet_buf, get_json_packet_to_send(cmRespond)); });
+  CHECK(n == 0);
+  CHECK(tx_contains(udp, "\"name\":\"any_relay\""));
+
+  // команда реле по имени
+  n = count_allocations(udp, [&]()
+                        { send_udp_packet(address, packet_buf, get_json_packet_to_send(name, cmSwitch)); });
+  CHECK(n == 0);
+  CHECK(tx_contains(udp, "\"name\":\"kitchen\""));
+
+  // ответы реле в JSON
+  n = count_allocations(udp, [&]()
+                        { send_response(address, name, descr, rsOn, cmRespond, false, 0); });
+  CHECK(n == 0);
+  CHECK(tx_contains(udp, "\"descr\":\"kitchen light\""));
+  n = count_allocations(udp, [&]()
+                        { send_response(address, name, descr, rsOff, cmSwitch, false, 0); });
+  CHECK(n == 0);
+
+  // ответы реле в двоичном виде: на поиск - с именем и описанием, на команду - только хэш имени
+  n = count_allocations(udp, [&]()
+                        { send_response(address, name, descr, rsOn, cmRespond, true, 1); });
+  CHECK(n == 0);
+  CHECK(tx_contains(udp, "kitchen light"));
+  n = count_allocations(udp, [&]()
+                        { send_response(address, name, descr, rsOff, cmSwitch, true, 2); });
+  CHECK(n == 0);
+  CHECK(!tx_contains(udp, "kitchen"));
+
+  printf("packet_alloc_test: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
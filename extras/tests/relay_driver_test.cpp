@@ -0,0 +1,123 @@
+// проверка драйверов выходов реле: накопленные изменения каналов должны переноситься на выходы
+// одной записью в регистры или одной транзакцией на шине; порядок вызовов драйверов модулем
+// реле проверяется в relay_output_test; запуск - make -C extras/tests
+
+#include <stdio.h>
+#include "mock_relay_driver.h"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+static void test_attach_channel()
+{
+  // начальный уровень выставляется сразу, без ожидания commitStaged()
+  srMockRelayDriver a;
+  a.attachChannel(5, true);
+  CHECK(a.writes.size() == 1);
+  CHECK(a.writes.back() == 0x20);
+  a.commitStaged();
+  CHECK(a.writes.size() == 1);
+}
+
+static void test_74hc595()
+{
+  test_reset_hardware();
+  sr74hc595Driver drv(1, 2, 3, 2);
+  CHECK(drv.getChannelCount() == 16);
+  drv.attachChannel(0, false);
+  hw.shifted.clear();
+  uint16_t latch = hw.rises[3];
+
+  // 16 каналов - одна передача по байту на регистр и один импульс защелки
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    drv.stageChannel(i, i != 9);
+  }
+  drv.commitStaged();
+  CHECK(hw.shifted.size() == 2);
+  CHECK(hw.rises[3] == latch + 1);
+  // первым выдвигается байт последнего регистра цепочки
+  CHECK(hw.shifted.size() == 2 && hw.shifted[0] == 0xFD && hw.shifted[1] == 0xFF);
+
+  // уровни не изменились - на шину ничего не передается
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    drv.stageChannel(i, i != 9);
+  }
+  drv.commitStaged();
+  CHECK(hw.shifted.size() == 2);
+  CHECK(hw.rises[3] == latch + 1);
+
+  // каналы за пределами цепочки игнорируются
+  drv.stageChannel(16, true);
+  drv.commitStaged();
+  CHECK(hw.shifted.size() == 2);
+}
+
+static void test_pcf8574()
+{
+  TwoWire wire;
+  srPcf8574Driver drv(0x20, &wire);
+  drv.attachChannel(0, true);
+  CHECK(wire.transmissions == 1);
+
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    drv.stageChannel(i, i & 1);
+  }
+  drv.commitStaged();
+  CHECK(wire.transmissions == 2);
+  CHECK(wire.data.size() == 1 && wire.data[0] == 0xAA);
+}
+
+static void test_mcp23017()
+{
+  TwoWire wire;
+  srMcp23017Driver drv(0x20, &wire);
+  drv.attachChannel(0, false);
+  drv.attachChannel(15, false);
+  uint16_t start = wire.transmissions;
+
+  // оба порта - одной транзакцией: адрес регистра OLATA и два байта
+  drv.stageChannel(0, true);
+  drv.stageChannel(15, true);
+  drv.commitStaged();
+  CHECK(wire.transmissions == start + 1);
+  CHECK(wire.data.size() == 3 && wire.data[0] == 0x14 && wire.data[1] == 0x01 && wire.data[2] == 0x80);
+}
+
+static void test_gpio()
+{
+  test_reset_hardware();
+  srGpioDriver drv;
+
+  // пины 0..31 - по одной записи в регистры set и clear на все пины
+  drv.stageChannel(2, true);
+  drv.stageChannel(4, false);
+  drv.stageChannel(5, true);
+  drv.commitStaged();
+  CHECK(hw.reg_writes == 2);
+  CHECK(hw.w1ts == 0x24);
+  CHECK(hw.w1tc == 0x10);
+
+  drv.commitStaged();
+  CHECK(hw.reg_writes == 2);
+}
+
+int main()
+{
+  test_attach_channel();
+  test_74hc595();
+  test_pcf8574();
+  test_mcp23017();
+  test_gpio();
+
+  printf("relay_driver_test: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
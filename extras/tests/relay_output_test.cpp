@@ -0,0 +1,136 @@
+// перенос состояния реле на выходы самим модулем реле: групповые команды (UDP-команда всем
+// реле и /relay_setstates) пишут в каждый драйвер один раз, одиночные - только в драйвер
+// измененного реле; заодно замеряется пропускная способность с пакетной записью и без нее;
+// запуск - make -C extras/tests
+
+#include <stdio.h>
+#include <chrono>
+#include "shSRControl.cpp"
+#include "mock_relay_driver.h"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+static const uint8_t relay_count = 32;
+
+// 32 реле на двух драйверах вперемешку: четные - каналы драйвера a, нечетные - драйвера b
+static srMockRelayDriver a, b;
+static shRelayControl relays;
+static WebServer server;
+static FS file_system;
+static WiFiUDP udp;
+
+static void send_udp_command(const char *_command)
+{
+  udp.test_receive(IPAddress(192, 168, 1, 20), IPAddress(192, 168, 1, 10),
+                   std::string("{\"name\":\"any_relay\",\"command\":\"") + _command + "\"}");
+  relays.tick();
+}
+
+// тело запроса /relay_setstates для реле с номерами из _mask
+static String get_states_json(uint32_t _mask, bool _state)
+{
+  String result = "{\"relays\":[";
+  for (uint8_t i = 0; i < relay_count; i++)
+  {
+    if (_mask & (1UL << i))
+    {
+      result += (result.endsWith("[")) ? "" : ",";
+      result += "{\"relay\":" + String(i) + ",\"state\":" + ((_state) ? "\"on\"}" : "\"off\"}");
+    }
+  }
+  return (result + "]}");
+}
+
+static void test_batched_commit()
+{
+  size_t wa = a.writes.size();
+  size_t wb = b.writes.size();
+
+  // команда всем реле - по одной записи на драйвер, со всеми каналами сразу
+  send_udp_command("set_on");
+  CHECK(a.writes.size() == wa + 1);
+  CHECK(b.writes.size() == wb + 1);
+  CHECK(a.writes.back() == 0xFFFF);
+  CHECK(b.writes.back() == 0xFFFF);
+
+  // несколько реле обоих драйверов одним запросом - снова по одной записи
+  server.test_request(HTTP_POST, "/relay_setstates", {{"plain", get_states_json(0x0000000F, false)}});
+  CHECK(server.response_code == 200);
+  CHECK(a.writes.size() == wa + 2);
+  CHECK(b.writes.size() == wb + 2);
+  CHECK(a.writes.back() == 0xFFFC);
+  CHECK(b.writes.back() == 0xFFFC);
+
+  // изменение реле только одного драйвера - второй драйвер не пишется
+  server.test_request(HTTP_POST, "/relay_setstates", {{"plain", get_states_json(0x00000004, true)}});
+  CHECK(a.writes.size() == wa + 3);
+  CHECK(b.writes.size() == wb + 2);
+  CHECK(a.writes.back() == 0xFFFE);
+  relays.setRelayState(5, false);
+  CHECK(a.writes.size() == wa + 3);
+  CHECK(b.writes.size() == wb + 3);
+  CHECK(b.writes.back() == 0xFFF8);
+}
+
+// среднее время одного вызова _fn(i) при _count вызовах, мкс
+template <typename F>
+static double measure_us(uint32_t _count, F _fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < _count; i++)
+  {
+    _fn(i);
+  }
+  std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+  return (time.count() / _count);
+}
+
+static void test_throughput()
+{
+  const uint32_t count = 2000;
+
+  // переключение реле по одному: каждое изменение - отдельная запись в драйвер
+  size_t writes = a.writes.size() + b.writes.size();
+  double single_us = measure_us(count, [](uint32_t i)
+                                { relays.switchRelay(i % relay_count); });
+  double single_writes = (double)(a.writes.size() + b.writes.size() - writes) / count;
+  CHECK(single_writes == 1.0);
+
+  // переключение всех реле одной командой: две записи на 32 изменения
+  writes = a.writes.size() + b.writes.size();
+  double batch_us = measure_us(count, [](uint32_t)
+                               { send_udp_command("switch"); });
+  double batch_writes = (double)(a.writes.size() + b.writes.size() - writes) / count;
+  CHECK(batch_writes == 2.0);
+
+  printf("           changes  writes/change  us/command  changes/s\n");
+  printf("single   %9u %14.3f %11.2f %10.0f\n",
+         count, single_writes, single_us, 1e6 / single_us);
+  printf("batched  %9u %14.3f %11.2f %10.0f\n",
+         count * relay_count, batch_writes / relay_count, batch_us, 1e6 * relay_count / batch_us);
+}
+
+int main()
+{
+  relays.init(0);
+  relays.setLogOnState(false);
+  for (uint8_t i = 0; i < relay_count; i++)
+  {
+    relays.addRelay("relay_" + String(i), i / 2, HIGH, nullptr, "", (i & 1) ? &b : &a);
+  }
+  relays.attachWebInterface(&server, &file_system);
+  relays.startDevice(&udp, 4210);
+
+  test_batched_commit();
+  test_throughput();
+
+  printf("relay_output_test: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,135 @@
+// замеры на больших таблицах реле (256 и более): рост таблицы в addRelay(), построение индекса
+// имен и поиск по нему, сохранение настроек в JSON и их загрузка через srStringStream, отдача
+// /relay_getstate; заодно проверяется, что после сохранения и загрузки все реле на месте;
+// запуск - make -C extras/tests
+
+#include <stdio.h>
+#include <chrono>
+#include "shSRControl.cpp"
+#include "mock_relay_driver.h"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+// среднее время одного вызова _fn(i) при _count вызовах, мкс
+template <typename F>
+static double measure_us(uint32_t _count, F _fn)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < _count; i++)
+  {
+    _fn(i);
+  }
+  std::chrono::duration<double, std::micro> time = std::chrono::steady_clock::now() - start;
+  return (time.count() / _count);
+}
+
+static String get_test_name(uint16_t i) { return ("relay_" + String(i)); }
+
+static void bench_relay_table(uint16_t _count)
+{
+  // по 64 реле на драйвер
+  std::vector<srMockRelayDriver> drivers(_count / SR_MAX_DRIVER_CHANNELS + 1);
+  shRelayControl relays;
+  relays.init(0);
+  relays.setLogOnState(false);
+
+  // таблица растет с нуля по мере добавления реле
+  double add_us = measure_us(_count, [&](uint32_t i)
+                             { relays.addRelay(get_test_name(i), i % SR_MAX_DRIVER_CHANNELS, HIGH, nullptr,
+                                               "description of relay " + String(i),
+                                               &drivers[i / SR_MAX_DRIVER_CHANNELS]); });
+  CHECK(ctx->relayCount == _count);
+
+  double index_us = measure_us(100, [](uint32_t)
+                               { build_name_index(mtRelay); });
+
+  // поиск каждого реле по хэшу и имени, как при разборе команды
+  std::vector<String> names;
+  std::vector<uint32_t> hashes;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    names.push_back(get_test_name(i));
+    hashes.push_back(get_name_hash(names[i].c_str()));
+  }
+  uint32_t found = 0;
+  double lookup_us = measure_us(_count * 100, [&](uint32_t i)
+                                {
+                                  uint16_t n = i % _count;
+                                  found += find_in_name_index(mtRelay, hashes[n], names[n].c_str()) == n; });
+  CHECK(found == _count * 100u);
+  CHECK(find_in_name_index(mtRelay, get_name_hash("no_such_relay"), "no_such_relay") == -1);
+
+  // сохранение настроек - тот же вывод, что пишется в файл
+  for (uint16_t i = 0; i < _count; i += 3)
+  {
+    set_local_relay_state(i, true);
+  }
+  String json;
+  json.reserve(_count * 64);
+  size_t len = 0;
+  double save_us = measure_us(20, [&](uint32_t)
+                              {
+                                json = "";
+                                srStringPrint out(json);
+                                len = write_config_json(out, mtRelay); });
+  CHECK(len > 0 && len == json.length());
+
+  // загрузка в чистую таблицу: общие параметры, затем реле по одному, как в load_config_file()
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    ctx->relayArray[i].relayName = "";
+    ctx->relayArray[i].relayDescription = "";
+    ctx->relayArray[i].relayLastState = false;
+  }
+  DynamicJsonDocument doc(CONFIG_SIZE);
+  bool loaded = true;
+  double load_us = measure_us(20, [&](uint32_t)
+                              {
+                                srStringStream params(json);
+                                loaded &= !read_config_params(doc, params);
+                                srStringStream in(json);
+                                loaded &= load_setting(mtRelay, doc, in); });
+  CHECK(loaded);
+  bool same = true;
+  for (uint16_t i = 0; i < _count; i++)
+  {
+    same &= ctx->relayArray[i].relayName == get_test_name(i) &&
+            ctx->relayArray[i].relayDescription == "description of relay " + String(i) &&
+            ctx->relayArray[i].relayLastState == (i % 3 == 0) &&
+            find_in_name_index(mtRelay, hashes[i], names[i].c_str()) == i;
+  }
+  CHECK(same);
+
+  // /relay_getstate - ответ собирается по частям, по одному реле
+  WebServer server;
+  ctx->http_server = &server;
+  double state_us = measure_us(20, [](uint32_t)
+                               { send_relays_json(mtRelay, false, 0); });
+  StaticJsonDocument<RELAY_DATA_SIZE> filter;
+  filter[FPSTR(sr_version_str)] = true;
+  StaticJsonDocument<RELAY_DATA_SIZE> state;
+  CHECK(server.response_code == 200);
+  CHECK(!deserializeJson(state, server.response_body.c_str(), DeserializationOption::Filter(filter)));
+  CHECK(server.response_body.find("\"relay_" + std::to_string(_count - 1) + "\"") != std::string::npos);
+  ctx->http_server = NULL;
+
+  printf("%6u %12.2f %10.2f %11.3f %10.1f %10.1f %10.1f %8u\n",
+         _count, add_us, index_us, lookup_us * 1000, save_us, load_us, state_us, (unsigned)len);
+}
+
+int main()
+{
+  printf("relays  add, us/relay  index, us  lookup, ns  save, us  load, us  state, us  json, b\n");
+  bench_relay_table(256);
+  bench_relay_table(SR_MAX_RELAY_COUNT);
+
+  printf("relay_table_bench: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,511 @@
+// замена Arduino.h для проверки библиотеки на компьютере: строки, потоки и время работают
+// как в ядре Arduino, а обращения драйверов к пинам и регистрам GPIO записываются в hw, чтобы
+// тест мог их посчитать
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <vector>
+#include "soc/gpio_reg.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define MSBFIRST 1
+#define LSBFIRST 0
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+
+// строки во флеш-памяти на компьютере - обычные строки
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper *)(s))
+#define FPSTR(s) ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+#define pgm_read_ptr(p) (*(const void *const *)(p))
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+class __FlashStringHelper;
+
+// тест собирается как для ESP32, номера регистров - в soc/gpio_reg.h
+#define REG_WRITE(_reg, _val) test_reg_write(_reg, _val)
+
+struct TestHardware
+{
+  uint8_t level[64];
+  uint16_t rises[64];           // количество переходов пина из LOW в HIGH
+  std::vector<uint8_t> shifted; // байты, выдвинутые через shiftOut()
+  uint16_t reg_writes;
+  uint32_t w1ts;
+  uint32_t w1tc;
+};
+
+inline TestHardware hw;
+
+inline void test_reset_hardware() { hw = TestHardware(); }
+
+inline void digitalWrite(uint8_t _pin, uint8_t _val)
+{
+  if (_val && !hw.level[_pin])
+  {
+    hw.rises[_pin]++;
+  }
+  hw.level[_pin] = _val;
+}
+
+inline int digitalRead(uint8_t _pin) { return (hw.level[_pin]); }
+
+inline void pinMode(uint8_t, uint8_t) {}
+
+inline void shiftOut(uint8_t, uint8_t, uint8_t, uint8_t _val) { hw.shifted.push_back(_val); }
+
+inline void test_reg_write(uint32_t _reg, uint32_t _val)
+{
+  hw.reg_writes++;
+  (_reg == GPIO_OUT_W1TS_REG) ? hw.w1ts = _val : hw.w1tc = _val;
+}
+
+inline void tone(uint8_t, unsigned int, unsigned long = 0) {}
+inline void noTone(uint8_t) {}
+
+// время модуля идет только тогда, когда его переводит тест или delay()
+inline unsigned long test_millis = 0;
+
+inline unsigned long millis() { return (test_millis); }
+inline unsigned long micros() { return (test_millis * 1000); }
+inline void delay(unsigned long _ms) { test_millis += _ms; }
+inline void yield() {}
+
+inline uint32_t esp_random() { return ((uint32_t)rand() << 16 ^ (uint32_t)rand()); }
+
+// ==== String =======================================
+
+// как и в ядре Arduino, непустая строка всегда хранится в куче, поэтому тест, считающий
+// выделения памяти, видит каждую созданную по ходу дела строку
+class String
+{
+private:
+  char *buffer = nullptr;
+  unsigned int capacity = 0;
+  unsigned int len = 0;
+
+  bool grow(unsigned int _size)
+  {
+    if (_size <= capacity)
+    {
+      return (true);
+    }
+    char *buf = new char[_size + 1];
+    if (buffer)
+    {
+      memcpy(buf, buffer, len + 1);
+      delete[] buffer;
+    }
+    else
+    {
+      buf[0] = 0;
+    }
+    buffer = buf;
+    capacity = _size;
+    return (true);
+  }
+
+  String &copy(const char *_str, unsigned int _len)
+  {
+    if (_len == 0)
+    {
+      if (buffer)
+      {
+        buffer[0] = 0;
+      }
+      len = 0;
+      return (*this);
+    }
+    grow(_len);
+    memmove(buffer, _str, _len);
+    buffer[_len] = 0;
+    len = _len;
+    return (*this);
+  }
+
+public:
+  String(const char *_str = "") { copy(_str, (_str) ? strlen(_str) : 0); }
+  String(const char *_str, unsigned int _len) { copy(_str, _len); }
+  String(const __FlashStringHelper *_str) : String((const char *)_str) {}
+  String(const String &_str) { copy(_str.c_str(), _str.len); }
+  String(String &&_str) : buffer(_str.buffer), capacity(_str.capacity), len(_str.len)
+  {
+    _str.buffer = nullptr;
+    _str.capacity = _str.len = 0;
+  }
+  explicit String(char _c) { copy(&_c, 1); }
+  explicit String(unsigned char _val, unsigned char _base = 10) : String((unsigned long)_val, _base) {}
+  explicit String(int _val, unsigned char _base = 10) : String((long)_val, _base) {}
+  explicit String(unsigned int _val, unsigned char _base = 10) : String((unsigned long)_val, _base) {}
+  explicit String(long _val, unsigned char _base = 10)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), (_base == 16) ? "%lx" : "%ld", _val);
+    copy(buf, strlen(buf));
+  }
+  explicit String(unsigned long _val, unsigned char _base = 10)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), (_base == 16) ? "%lx" : "%lu", _val);
+    copy(buf, strlen(buf));
+  }
+  explicit String(float _val, unsigned char _decimals = 2) : String((double)_val, _decimals) {}
+  explicit String(double _val, unsigned char _decimals = 2)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", _decimals, _val);
+    copy(buf, strlen(buf));
+  }
+  ~String() { delete[] buffer; }
+
+  String &operator=(const String &_str) { return ((this == &_str) ? *this : copy(_str.c_str(), _str.len)); }
+  String &operator=(String &&_str)
+  {
+    if (this != &_str)
+    {
+      delete[] buffer;
+      buffer = _str.buffer;
+      capacity = _str.capacity;
+      len = _str.len;
+      _str.buffer = nullptr;
+      _str.capacity = _str.len = 0;
+    }
+    return (*this);
+  }
+  String &operator=(const char *_str) { return (copy(_str, (_str) ? strlen(_str) : 0)); }
+  String &operator=(const __FlashStringHelper *_str) { return (*this = (const char *)_str); }
+
+  bool reserve(unsigned int _size) { return (grow(_size)); }
+  unsigned int length() const { return (len); }
+  bool isEmpty() const { return (len == 0); }
+  const char *c_str() const { return ((buffer) ? buffer : ""); }
+  char *begin() { return (buffer); }
+  char *end() { return (buffer + len); }
+
+  bool concat(const char *_str, unsigned int _len)
+  {
+    if (_len == 0)
+    {
+      return (true);
+    }
+    grow(len + _len);
+    memmove(buffer + len, _str, _len);
+    len += _len;
+    buffer[len] = 0;
+    return (true);
+  }
+  bool concat(const char *_str) { return ((_str) ? concat(_str, strlen(_str)) : false); }
+  bool concat(const String &_str) { return (concat(_str.c_str(), _str.len)); }
+  bool concat(const __FlashStringHelper *_str) { return (concat((const char *)_str)); }
+  bool concat(char _c) { return (concat(&_c, 1)); }
+  bool concat(unsigned char _val) { return (concat(String(_val))); }
+  bool concat(int _val) { return (concat(String(_val))); }
+  bool concat(unsigned int _val) { return (concat(String(_val))); }
+  bool concat(long _val) { return (concat(String(_val))); }
+  bool concat(unsigned long _val) { return (concat(String(_val))); }
+  bool concat(double _val) { return (concat(String(_val))); }
+
+  template <typename T>
+  String &operator+=(const T &_val)
+  {
+    concat(_val);
+    return (*this);
+  }
+
+  char charAt(unsigned int _index) const { return ((_index < len) ? buffer[_index] : 0); }
+  char operator[](unsigned int _index) const { return (charAt(_index)); }
+  char &operator[](unsigned int _index) { return (buffer[_index]); }
+  void setCharAt(unsigned int _index, char _c)
+  {
+    if (_index < len)
+    {
+      buffer[_index] = _c;
+    }
+  }
+
+  int compareTo(const String &_str) const { return (strcmp(c_str(), _str.c_str())); }
+  bool equals(const String &_str) const { return (len == _str.len && compareTo(_str) == 0); }
+  bool equals(const char *_str) const { return (strcmp(c_str(), (_str) ? _str : "") == 0); }
+  bool operator==(const String &_str) const { return (equals(_str)); }
+  bool operator==(const char *_str) const { return (equals(_str)); }
+  bool operator!=(const String &_str) const { return (!equals(_str)); }
+  bool operator!=(const char *_str) const { return (!equals(_str)); }
+  bool operator<(const String &_str) const { return (compareTo(_str) < 0); }
+
+  bool startsWith(const String &_str) const
+  {
+    return (_str.len <= len && strncmp(c_str(), _str.c_str(), _str.len) == 0);
+  }
+  bool endsWith(const String &_str) const
+  {
+    return (_str.len <= len && strcmp(c_str() + len - _str.len, _str.c_str()) == 0);
+  }
+
+  int indexOf(char _c, unsigned int _from = 0) const
+  {
+    const char *p = (_from < len) ? strchr(c_str() + _from, _c) : nullptr;
+    return ((p) ? (int)(p - c_str()) : -1);
+  }
+  int indexOf(const String &_str, unsigned int _from = 0) const
+  {
+    const char *p = (_from <= len) ? strstr(c_str() + _from, _str.c_str()) : nullptr;
+    return ((p) ? (int)(p - c_str()) : -1);
+  }
+  int lastIndexOf(char _c) const
+  {
+    const char *p = strrchr(c_str(), _c);
+    return ((p) ? (int)(p - c_str()) : -1);
+  }
+
+  String substring(unsigned int _from) const { return (substring(_from, len)); }
+  String substring(unsigned int _from, unsigned int _to) const
+  {
+    if (_from > _to)
+    {
+      unsigned int t = _from;
+      _from = _to;
+      _to = t;
+    }
+    _to = (_to > len) ? len : _to;
+    return ((_from >= _to) ? String() : String(c_str() + _from, _to - _from));
+  }
+
+  void remove(unsigned int _index) { remove(_index, (unsigned int)-1); }
+  void remove(unsigned int _index, unsigned int _count)
+  {
+    if (_index >= len)
+    {
+      return;
+    }
+    _count = (_count > len - _index) ? len - _index : _count;
+    memmove(buffer + _index, buffer + _index + _count, len - _index - _count + 1);
+    len -= _count;
+  }
+
+  void replace(const String &_find, const String &_replace)
+  {
+    if (_find.len == 0)
+    {
+      return;
+    }
+    String result;
+    for (int from = 0, pos; from <= (int)len; from = pos + _find.len)
+    {
+      pos = indexOf(_find, from);
+      if (pos < 0)
+      {
+        result.concat(c_str() + from, len - from);
+        break;
+      }
+      result.concat(c_str() + from, pos - from);
+      result.concat(_replace);
+    }
+    *this = result;
+  }
+
+  void trim()
+  {
+    unsigned int from = 0;
+    while (from < len && (buffer[from] == ' ' || buffer[from] == '\t' || buffer[from] == '\r' || buffer[from] == '\n'))
+    {
+      from++;
+    }
+    unsigned int to = len;
+    while (to > from && (buffer[to - 1] == ' ' || buffer[to - 1] == '\t' || buffer[to - 1] == '\r' || buffer[to - 1] == '\n'))
+    {
+      to--;
+    }
+    *this = substring(from, to);
+  }
+
+  long toInt() const { return (atol(c_str())); }
+  float toFloat() const { return ((float)atof(c_str())); }
+
+  void toCharArray(char *_buf, unsigned int _size) const { getBytes((unsigned char *)_buf, _size); }
+  void getBytes(unsigned char *_buf, unsigned int _size) const
+  {
+    if (_size == 0)
+    {
+      return;
+    }
+    unsigned int n = (len < _size - 1) ? len : _size - 1;
+    memcpy(_buf, c_str(), n);
+    _buf[n] = 0;
+  }
+};
+
+class StringSumHelper : public String
+{
+public:
+  StringSumHelper(const String &_str) : String(_str) {}
+  StringSumHelper(const char *_str) : String(_str) {}
+};
+
+template <typename T>
+inline StringSumHelper operator+(const String &_left, const T &_right)
+{
+  StringSumHelper result(_left);
+  result.concat(_right);
+  return (result);
+}
+
+inline StringSumHelper operator+(const char *_left, const String &_right)
+{
+  StringSumHelper result(_left);
+  result.concat(_right);
+  return (result);
+}
+
+inline bool operator==(const char *_left, const String &_right) { return (_right == _left); }
+inline bool operator!=(const char *_left, const String &_right) { return (_right != _left); }
+
+inline const String emptyString;
+
+// ==== Print и Stream ===============================
+
+class Print;
+
+class Printable
+{
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+class Print
+{
+private:
+  size_t printNumber(const char *_format, long long _val)
+  {
+    char buf[24];
+    snprintf(buf, sizeof(buf), _format, _val);
+    return (write(buf));
+  }
+
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t _c) = 0;
+  virtual size_t write(const uint8_t *_buf, size_t _size)
+  {
+    size_t n = 0;
+    while (_size-- && write(*_buf++))
+    {
+      n++;
+    }
+    return (n);
+  }
+  virtual int availableForWrite() { return (0); }
+  virtual void flush() {}
+
+  size_t write(const char *_str) { return ((_str) ? write((const uint8_t *)_str, strlen(_str)) : 0); }
+  size_t write(const char *_buf, size_t _size) { return (write((const uint8_t *)_buf, _size)); }
+
+  size_t print(const char *_str) { return (write(_str)); }
+  size_t print(const __FlashStringHelper *_str) { return (write((const char *)_str)); }
+  size_t print(const String &_str) { return (write(_str.c_str(), _str.length())); }
+  size_t print(char _c) { return (write((uint8_t)_c)); }
+  size_t print(unsigned char _val, int = DEC) { return (printNumber("%lld", _val)); }
+  size_t print(int _val, int = DEC) { return (printNumber("%lld", _val)); }
+  size_t print(unsigned int _val, int = DEC) { return (printNumber("%lld", _val)); }
+  size_t print(long _val, int = DEC) { return (printNumber("%lld", _val)); }
+  size_t print(unsigned long _val, int = DEC) { return (printNumber("%llu", _val)); }
+  size_t print(double _val, int _digits = 2)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", _digits, _val);
+    return (write(buf));
+  }
+  size_t print(const Printable &_val) { return (_val.printTo(*this)); }
+
+  size_t println() { return (write("\r\n")); }
+  template <typename T>
+  size_t println(const T &_val)
+  {
+    size_t n = print(_val);
+    return (n + println());
+  }
+};
+
+class Stream : public Print
+{
+protected:
+  unsigned long timeout = 1000;
+
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  // данные на компьютере не приходят с задержкой, поэтому тайм-аут не выдерживается
+  void setTimeout(unsigned long _timeout) { timeout = _timeout; }
+  unsigned long getTimeout() { return (timeout); }
+
+  size_t readBytes(char *_buf, size_t _size)
+  {
+    size_t n = 0;
+    for (int c; n < _size && (c = read()) >= 0; n++)
+    {
+      _buf[n] = (char)c;
+    }
+    return (n);
+  }
+  size_t readBytes(uint8_t *_buf, size_t _size) { return (readBytes((char *)_buf, _size)); }
+
+  bool find(const char *_target)
+  {
+    size_t n = strlen(_target);
+    for (size_t i = 0; i < n;)
+    {
+      int c = read();
+      if (c < 0)
+      {
+        return (false);
+      }
+      i = (c == _target[i]) ? i + 1 : (c == _target[0]) ? 1 : 0;
+    }
+    return (true);
+  }
+
+  String readString()
+  {
+    String result;
+    for (int c = read(); c >= 0; c = read())
+    {
+      result += (char)c;
+    }
+    return (result);
+  }
+};
+
+// вывод Serial - на консоль, если тест включит лог модуля
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t _c) override { return (fputc(_c, stdout) != EOF); }
+  int available() override { return (0); }
+  int read() override { return (-1); }
+  int peek() override { return (-1); }
+};
+
+inline HardwareSerial Serial;
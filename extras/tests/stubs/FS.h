@@ -0,0 +1,89 @@
+// замена файловой системы: файлы хранятся в памяти, содержимое любого файла доступно тесту
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace fs
+{
+  class File : public Stream
+  {
+  private:
+    std::string *data = nullptr;
+    size_t pos = 0;
+    bool writable = false;
+
+  public:
+    File() {}
+    File(std::string *_data, bool _writable, bool _append)
+        : data(_data), pos((_append) ? _data->size() : 0), writable(_writable) {}
+
+    size_t write(uint8_t _c) override { return (write(&_c, 1)); }
+    size_t write(const uint8_t *_buf, size_t _size) override
+    {
+      if (!data || !writable)
+      {
+        return (0);
+      }
+      data->replace(pos, (pos + _size < data->size()) ? _size : data->size() - pos, (const char *)_buf, _size);
+      pos += _size;
+      return (_size);
+    }
+    int available() override { return ((data) ? (int)(data->size() - pos) : 0); }
+    int read() override { return ((data && pos < data->size()) ? (uint8_t)(*data)[pos++] : -1); }
+    size_t read(uint8_t *_buf, size_t _size) { return (readBytes(_buf, _size)); }
+    int peek() override { return ((data && pos < data->size()) ? (uint8_t)(*data)[pos] : -1); }
+    bool seek(uint32_t _pos)
+    {
+      if (!data || _pos > data->size())
+      {
+        return (false);
+      }
+      pos = _pos;
+      return (true);
+    }
+    size_t position() const { return (pos); }
+    size_t size() const { return ((data) ? data->size() : 0); }
+    void close() { data = nullptr; }
+    explicit operator bool() const { return (data != nullptr); }
+  };
+
+  class FS
+  {
+  public:
+    std::map<std::string, std::string> files;
+
+    File open(const String &_path, const char *_mode = "r")
+    {
+      std::string path = _path.c_str();
+      if (_mode[0] == 'r')
+      {
+        auto f = files.find(path);
+        return ((f == files.end()) ? File() : File(&f->second, _mode[1] == '+', false));
+      }
+      if (_mode[0] == 'w')
+      {
+        files[path].clear();
+      }
+      return (File(&files[path], true, _mode[0] == 'a'));
+    }
+    bool exists(const String &_path) { return (files.count(_path.c_str()) > 0); }
+    bool remove(const String &_path) { return (files.erase(_path.c_str()) > 0); }
+    bool rename(const String &_from, const String &_to)
+    {
+      auto f = files.find(_from.c_str());
+      if (f == files.end())
+      {
+        return (false);
+      }
+      std::string data = f->second;
+      files.erase(f);
+      files[_to.c_str()] = data;
+      return (true);
+    }
+  };
+} // namespace fs
+
+using fs::File;
+using fs::FS;
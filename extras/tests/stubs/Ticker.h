@@ -0,0 +1,13 @@
+// замена Ticker: таймеры в тестах не срабатывают
+#pragma once
+#include <Arduino.h>
+
+class Ticker
+{
+public:
+  void attach_ms(uint32_t, void (*)()) {}
+  template <typename T>
+  void attach_ms(uint32_t, void (*)(T), T) {}
+  void once_ms(uint32_t, void (*)()) {}
+  void detach() {}
+};
@@ -0,0 +1,126 @@
+// замена WebServer esp32: тест вызывает обработчики запросов через test_request(), ответ
+// сервера (код, тип и тело, в т.ч. переданное частями) собирается в полях response_*
+#pragma once
+#include <WiFi.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum HTTPMethod
+{
+  HTTP_ANY,
+  HTTP_GET,
+  HTTP_HEAD,
+  HTTP_POST,
+  HTTP_PUT,
+  HTTP_PATCH,
+  HTTP_DELETE,
+  HTTP_OPTIONS
+};
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+class WebServer
+{
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+private:
+  struct Handler
+  {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+  std::vector<Handler> handlers;
+  std::vector<std::pair<String, String>> args;
+  std::vector<std::pair<String, String>> headers;
+  WiFiClient current_client;
+
+  const String *find(const std::vector<std::pair<String, String>> &_list, const String &_name)
+  {
+    for (auto &item : _list)
+    {
+      if (item.first == _name)
+      {
+        return (&item.second);
+      }
+    }
+    return (nullptr);
+  }
+
+public:
+  int response_code = 0;
+  String response_type;
+  std::string response_body;
+
+  WebServer(int = 80) {}
+  void begin() {}
+  void handleClient() {}
+
+  void on(const String &_uri, HTTPMethod _method, THandlerFunction _fn) { handlers.push_back({_uri, _method, _fn}); }
+  void on(const String &_uri, THandlerFunction _fn) { on(_uri, HTTP_ANY, _fn); }
+
+  // обработка запроса, как это сделал бы сервер: вызывается первый подходящий обработчик
+  bool test_request(HTTPMethod _method,
+                    const String &_uri,
+                    const std::vector<std::pair<String, String>> &_args = {},
+                    const std::vector<std::pair<String, String>> &_headers = {})
+  {
+    args = _args;
+    headers = _headers;
+    response_code = 0;
+    response_type = "";
+    response_body.clear();
+    for (auto &h : handlers)
+    {
+      if (h.uri == _uri && (h.method == HTTP_ANY || h.method == _method))
+      {
+        h.fn();
+        return (true);
+      }
+    }
+    return (false);
+  }
+
+  bool hasArg(const String &_name) { return (find(args, _name) != nullptr); }
+  String arg(const String &_name)
+  {
+    const String *value = find(args, _name);
+    return ((value) ? *value : String());
+  }
+  int args_count() { return ((int)args.size()); }
+
+  void collectHeaders(const char **, size_t) {}
+  bool hasHeader(const String &_name) { return (find(headers, _name) != nullptr); }
+  String header(const String &_name)
+  {
+    const String *value = find(headers, _name);
+    return ((value) ? *value : String());
+  }
+  void sendHeader(const String &, const String &, bool = false) {}
+  void setContentLength(size_t) {}
+
+  void send(int _code, const String &_type = String(), const String &_body = String())
+  {
+    response_code = _code;
+    response_type = _type;
+    response_body.assign(_body.c_str(), _body.length());
+  }
+  void send(int _code, const char *_type, const String &_body) { send(_code, String(_type), _body); }
+  void send_P(int _code, PGM_P _type, PGM_P _body, size_t _size)
+  {
+    response_code = _code;
+    response_type = _type;
+    response_body.assign(_body, _size);
+  }
+  void send_P(int _code, PGM_P _type, PGM_P _body) { send_P(_code, _type, _body, strlen(_body)); }
+
+  void sendContent(const String &_body) { response_body.append(_body.c_str(), _body.length()); }
+  void sendContent(const char *_body, size_t _size) { response_body.append(_body, _size); }
+  void sendContent_P(PGM_P _body) { response_body.append(_body); }
+
+  WiFiClient &client() { return (current_client); }
+  String uri() { return (String()); }
+};
@@ -0,0 +1,96 @@
+// замена WiFi esp32: адрес модуля и состояние подключения задает тест
+#pragma once
+#include <Arduino.h>
+#include <string>
+
+class IPAddress : public Printable
+{
+private:
+  uint8_t bytes[4] = {0, 0, 0, 0};
+
+public:
+  IPAddress() {}
+  IPAddress(uint8_t _a, uint8_t _b, uint8_t _c, uint8_t _d) : bytes{_a, _b, _c, _d} {}
+  IPAddress(uint32_t _address) { memcpy(bytes, &_address, 4); }
+
+  operator uint32_t() const
+  {
+    uint32_t result;
+    memcpy(&result, bytes, 4);
+    return (result);
+  }
+  bool operator==(const IPAddress &_address) const { return (memcmp(bytes, _address.bytes, 4) == 0); }
+  bool operator!=(const IPAddress &_address) const { return (!(*this == _address)); }
+  uint8_t operator[](int _index) const { return (bytes[_index]); }
+  uint8_t &operator[](int _index) { return (bytes[_index]); }
+
+  bool fromString(const char *_str)
+  {
+    unsigned int a, b, c, d;
+    if (sscanf(_str, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255)
+    {
+      return (false);
+    }
+    *this = IPAddress(a, b, c, d);
+    return (true);
+  }
+  bool fromString(const String &_str) { return (fromString(_str.c_str())); }
+
+  String toString() const
+  {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return (String(buf));
+  }
+
+  size_t printTo(Print &p) const override { return (p.print(toString())); }
+};
+
+class WiFiClass
+{
+public:
+  bool connected = true;
+  IPAddress local_ip = IPAddress(192, 168, 1, 10);
+  IPAddress subnet_mask = IPAddress(255, 255, 255, 0);
+  IPAddress ap_ip = IPAddress(192, 168, 4, 1);
+
+  bool isConnected() { return (connected); }
+  IPAddress localIP() { return ((connected) ? local_ip : IPAddress()); }
+  IPAddress subnetMask() { return (subnet_mask); }
+  IPAddress softAPIP() { return (ap_ip); }
+  IPAddress softAPBroadcastIP() { return (IPAddress(ap_ip[0], ap_ip[1], ap_ip[2], 255)); }
+};
+
+inline WiFiClass WiFi;
+
+// клиент HTTP-сервера; все, что в него пишется, собирается в data
+class WiFiClient : public Stream
+{
+public:
+  bool active = false;
+  int write_space = 4096; // свободное место в буфере отправки
+  std::string data;
+
+  size_t write(uint8_t _c) override { return (write(&_c, 1)); }
+  size_t write(const uint8_t *_buf, size_t _size) override
+  {
+    if (!active)
+    {
+      return (0);
+    }
+    data.append((const char *)_buf, _size);
+    return (_size);
+  }
+  int availableForWrite() override { return ((active) ? write_space : 0); }
+  int available() override { return (0); }
+  int read() override { return (-1); }
+  int peek() override { return (-1); }
+
+  uint8_t connected() { return (active); }
+  void stop() { active = false; }
+  void setNoDelay(bool) {}
+  int fd() const { return (-1); }
+  explicit operator bool() { return (active); }
+  IPAddress remoteIP() { return (IPAddress(192, 168, 1, 100)); }
+  uint16_t remotePort() { return (50000); }
+};
@@ -0,0 +1,96 @@
+// замена WiFiUDP: отправленный пакет остается в буфере, а принимаемые пакеты тест ставит
+// в очередь; отправка память не выделяет, чтобы ее можно было проверять счетчиком выделений
+#pragma once
+#include <WiFi.h>
+#include <deque>
+#include <string>
+
+class WiFiUDP : public Stream
+{
+private:
+  struct Packet
+  {
+    IPAddress from;
+    IPAddress to;
+    std::string data;
+  };
+  std::deque<Packet> incoming;
+  std::string rx;
+  size_t rx_pos = 0;
+  IPAddress remote_ip;
+  IPAddress destination_ip;
+
+public:
+  uint16_t port = 0;
+  IPAddress group;
+
+  // последний отправленный пакет
+  IPAddress tx_address;
+  uint8_t tx[1500];
+  size_t tx_len = 0;
+  uint32_t tx_count = 0;
+
+  uint8_t begin(uint16_t _port)
+  {
+    port = _port;
+    return (1);
+  }
+  uint8_t beginMulticast(IPAddress _group, uint16_t _port)
+  {
+    group = _group;
+    return (begin(_port));
+  }
+  void stop() {}
+
+  int beginPacket(IPAddress _address, uint16_t)
+  {
+    tx_address = _address;
+    tx_len = 0;
+    return (1);
+  }
+  size_t write(uint8_t _c) override { return (write(&_c, 1)); }
+  size_t write(const uint8_t *_buf, size_t _size) override
+  {
+    size_t n = (_size < sizeof(tx) - tx_len) ? _size : sizeof(tx) - tx_len;
+    memcpy(tx + tx_len, _buf, n);
+    tx_len += n;
+    return (n);
+  }
+  int endPacket()
+  {
+    tx_count++;
+    return (1);
+  }
+
+  // пакет, который модуль получит при следующем вызове parsePacket()
+  void test_receive(const IPAddress &_from, const IPAddress &_to, const std::string &_data)
+  {
+    incoming.push_back({_from, _to, _data});
+  }
+
+  int parsePacket()
+  {
+    if (incoming.empty())
+    {
+      rx.clear();
+      rx_pos = 0;
+      return (0);
+    }
+    remote_ip = incoming.front().from;
+    destination_ip = incoming.front().to;
+    rx = incoming.front().data;
+    rx_pos = 0;
+    incoming.pop_front();
+    return ((int)rx.size());
+  }
+  int available() override { return ((int)(rx.size() - rx_pos)); }
+  int read() override { return ((rx_pos < rx.size()) ? (uint8_t)rx[rx_pos++] : -1); }
+  int read(unsigned char *_buf, size_t _size) { return ((int)readBytes(_buf, _size)); }
+  int read(char *_buf, size_t _size) { return ((int)readBytes(_buf, _size)); }
+  int peek() override { return ((rx_pos < rx.size()) ? (uint8_t)rx[rx_pos] : -1); }
+  void flush() override { rx_pos = rx.size(); }
+
+  IPAddress remoteIP() { return (remote_ip); }
+  uint16_t remotePort() { return (port); }
+  IPAddress destinationIP() { return (destination_ip); }
+};
@@ -0,0 +1,25 @@
+// минимальная замена шины I2C: считаются транзакции и переданные байты
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+class TwoWire
+{
+public:
+  uint16_t transmissions = 0;
+  std::vector<uint8_t> data; // байты последней транзакции
+
+  void beginTransmission(uint8_t) { data.clear(); }
+  size_t write(uint8_t _val)
+  {
+    data.push_back(_val);
+    return (1);
+  }
+  uint8_t endTransmission()
+  {
+    transmissions++;
+    return (0);
+  }
+};
+
+inline TwoWire Wire;
@@ -0,0 +1,3 @@
+// select() для проверки клиентов /relay_events - системный
+#pragma once
+#include <sys/select.h>
@@ -0,0 +1,5 @@
+// регистры set/clear выходов GPIO 0..31; для GPIO 32..39 регистры не заданы,
+// такие пины драйвер переключает через digitalWrite()
+#pragma once
+#define GPIO_OUT_W1TS_REG 1
+#define GPIO_OUT_W1TC_REG 2
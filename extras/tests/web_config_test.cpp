@@ -0,0 +1,100 @@
+// модули реле и выключателя на одном Web-сервере: /sr_getconfig и /sr_setconfig обслуживает
+// обработчик модуля, зарегистрированного первым, но настройки отдаются и сохраняются для модуля,
+// указанного в "for"; неизвестный тип модуля и ошибки в запросе дают код 400;
+// запуск - make -C extras/tests
+
+#include <stdio.h>
+#include "shSRControl.cpp"
+
+static int failures = 0;
+
+#define CHECK(x)                                                   \
+  if (!(x))                                                        \
+  {                                                                \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x);   \
+    failures++;                                                    \
+  }
+
+static bool body_contains(WebServer &_server, const char *_str)
+{
+  return (_server.response_body.find(_str) != std::string::npos);
+}
+
+// есть ли _str в каком-либо из файлов настроек, имя которых начинается с _prefix
+static bool file_contains(FS &_fs, const std::string &_prefix, const char *_str)
+{
+  for (auto &file : _fs.files)
+  {
+    if (file.first.compare(0, _prefix.size(), _prefix) == 0 && file.second.find(_str) != std::string::npos)
+    {
+      return (true);
+    }
+  }
+  return (false);
+}
+
+int main()
+{
+  WebServer server;
+  FS file_system;
+  WiFiUDP udp;
+
+  shRelayControl relays;
+  relays.init(0);
+  relays.setLogOnState(false);
+  relays.addRelay("relay_one", 5, HIGH);
+  relays.attachWebInterface(&server, &file_system);
+  relays.startDevice(&udp, 4210);
+
+  shSwitchControl switches;
+  switches.init(0);
+  switches.setLogOnState(false);
+  switches.addRelay("remote_one");
+  switches.attachWebInterface(&server, &file_system, "/switch_config");
+  switches.startDevice(&udp, 4210);
+
+  // без "for" - настройки модуля, зарегистрировавшего обработчик первым
+  CHECK(server.test_request(HTTP_GET, "/sr_getconfig"));
+  CHECK(server.response_code == 200);
+  CHECK(body_contains(server, "\"for\":\"relay\""));
+  CHECK(body_contains(server, "\"relay_one\""));
+
+  server.test_request(HTTP_GET, "/sr_getconfig", {{"for", "switch"}});
+  CHECK(server.response_code == 200);
+  CHECK(body_contains(server, "\"for\":\"switch\""));
+  CHECK(body_contains(server, "\"remote_one\""));
+
+  server.test_request(HTTP_GET, "/sr_getconfig", {{"for", "dimmer"}});
+  CHECK(server.response_code == 400);
+
+  // настройки выключателя через обработчик модуля реле
+  server.test_request(HTTP_POST, "/sr_setconfig",
+                      {{"plain", "{\"for\":\"switch\",\"module\":\"hall\",\"relays\":[{\"name\":\"remote_two\",\"descr\":\"\"}]}"}});
+  CHECK(server.response_code == 200);
+  CHECK(switches.getRelayHandle("remote_two") == 0);
+  CHECK(relays.getRelayHandle("relay_one") == 0);
+  CHECK(file_contains(file_system, "/switch", "remote_two"));
+  CHECK(!file_contains(file_system, "/relay", "remote_two"));
+
+  server.test_request(HTTP_POST, "/sr_setconfig",
+                      {{"plain", "{\"for\":\"relay\",\"module\":\"kitchen\",\"save_state\":0,\"relays\":[{\"name\":\"relay_two\",\"descr\":\"lamp\"}]}"}});
+  CHECK(server.response_code == 200);
+  CHECK(relays.getRelayHandle("relay_two") == 0);
+  CHECK(switches.getRelayHandle("remote_two") == 0);
+
+  // ошибочные запросы ничего не меняют
+  server.test_request(HTTP_POST, "/sr_setconfig",
+                      {{"plain", "{\"for\":\"dimmer\",\"module\":\"x\",\"relays\":[{\"name\":\"other_name\",\"descr\":\"\"}]}"}});
+  CHECK(server.response_code == 400);
+  server.test_request(HTTP_POST, "/sr_setconfig", {{"plain", "{\"module\":\"x\",\"relays\":[]}"}});
+  CHECK(server.response_code == 400);
+  server.test_request(HTTP_POST, "/sr_setconfig", {{"plain", "{\"for\":"}});
+  CHECK(server.response_code == 400);
+  server.test_request(HTTP_POST, "/sr_setconfig");
+  CHECK(server.response_code == 400);
+  CHECK(relays.getRelayHandle("relay_two") == 0);
+  CHECK(switches.getRelayHandle("remote_two") == 0);
+
+  printf("web_config_test: %s\n", (failures == 0) ? "OK" : "FAILED");
+  return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+# Сборка Web-страниц модуля: страницы из этой папки сжимаются gzip и записываются
+# в src/extras в виде массивов PROGMEM вместе с ETag; запускать после каждого изменения страниц
+#
+#   python3 extras/web/build_pages.py
+
+import gzip
+import os
+import zlib
+
+PAGES = (
+    # исходный файл, заголовочный файл, имя массива
+    ('index.html', 'i_page.h', 'index_page'),
+    ('config.html', 'c_page.h', 'config_page'),
+)
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+OUT_DIR = os.path.join(HERE, '..', '..', 'src', 'extras')
+
+
+def build_page(source, header, name):
+    with open(os.path.join(HERE, source), 'rb') as f:
+        html = f.read().strip()
+
+    # mtime=0 - одинаковый результат при одинаковом исходнике, а значит и неизменный ETag
+    data = gzip.compress(html, compresslevel=9, mtime=0)
+    etag = '"%08x"' % (zlib.crc32(data) & 0xFFFFFFFF)
+
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in data[i:i + 16]) + ',')
+
+    with open(os.path.join(OUT_DIR, header), 'w', newline='\n') as f:
+        f.write('#pragma once\n\n')
+        f.write('#include <Arduino.h>\n\n')
+        f.write('// файл создан сценарием extras/web/build_pages.py из extras/web/%s, не редактировать\n\n' % source)
+        f.write('static const char %s_etag[] PROGMEM = "%s";\n' % (name, etag.replace('"', '\\"')))
+        f.write('static const size_t %s_gz_len = %d;\n' % (name, len(data)))
+        f.write('static const uint8_t %s_gz[] PROGMEM = {\n' % name)
+        f.write('\n'.join(lines))
+        f.write('\n};\n')
+
+    print('%s: %d -> %d bytes, ETag %s' % (header, len(html), len(data), etag))
+
+
+if __name__ == '__main__':
+    for page in PAGES:
+        build_page(*page)
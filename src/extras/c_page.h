@@ -2,5 +2,136 @@
 
 #include <Arduino.h>
 
-static const char config_page[] PROGMEM =
-    R"(<!DOCTYPE html><html> <head> <meta content='text/html; charset=UTF-8' http-equiv='content-type' /> <meta name='VIEWPORT' content='width=device-width, initial-scale=1.0' /> <style> body { margin: 0; font-size: 16px; font-weight: 400; line-height: 1.5; color: #212529; text-align: left; background-color: #fff; } .tabs { font-size: 0; max-width: 400px; margin-left: auto; margin-right: auto; } .tabs > h3 { font-size: 18pt; text-align: center; } #rel_list { border: 2px solid #e0e0e0; padding: 10px 15px; font-size: 16px; } #rel_list > h4 { margin-left: 10px; } label { margin-left: 10px; } input[type='text'] { display: block; margin-bottom: 10px; margin-left: 10px; width: 300px; } #label { display: none; } .save_btn { margin: 20px 25px; width: 120px; } .btn_right { margin-left: 20px; } </style> </head> <body> <p id='label'></p> <div class='tabs'> <h3 id='h3'></h3> <div id='rel_list'> <label id='save_last_state' style='margin: 15px 10px; display: block'> <input type='checkbox' id='save_state' style='margin-left: 0px' /> Сохранять состояние реле при перезагрузке</label > <label>Описание модуля</label> <input type='text' id='module' maxlength='64' placeholder='Описание модуля' /> <h4 id='h4'></h4> </div> <input type='button' value='Назад' class='save_btn' onclick="window.open('/', '_self', false);" /> <input type='button' id='btn_save' class='save_btn btn_right' value='Сохранить' onclick='sendData()' disabled /> </div> <script> var dest; function checkName() { var relays = document .getElementById('rel_list') .getElementsByClassName('relay'); for (var i = 0, len = relays.length; i < len; i++) { if (relays[i].value.length > 0 && relays[i].value.length < 6) { alert( 'Длина имени должна быть не менее 6 и не более 16 символов! \n\n Разрешенные символы: 0..9, A..Z, a..z, - , _' ); relays[i].focus(); return false; } } return true; } function sendData() { if (!checkName()) { return; } document.getElementById('btn_save').disabled = 'disabled'; var values = []; var relays = document .getElementById('rel_list') .getElementsByClassName('relay'); var descrs = document .getElementById('rel_list') .getElementsByClassName('descr'); for (var i = 0, len = relays.length; i < len; ++i) { let rel = { name: relays[i].value, descr: descrs[i].value }; values.push(rel); } var f_data = { for: dest, module: document.getElementById('module').value, save_state: document.getElementById('save_state').checked, relays: values, }; var xhr = new XMLHttpRequest(); xhr.open('POST', '/sr_setconfig', true); xhr.setRequestHeader('Content-Type', 'text/json'); xhr.onreadystatechange = function () { document.body.innerHTML = this.responseText; }; xhr.send(JSON.stringify(f_data)); } function btnSaveEnabled() { document.getElementById('btn_save').removeAttribute('disabled'); } function getConfig() { var c_lab = document.getElementById('label'); var c_page = c_lab.innerHTML; c_lab.innerHTML = ''; var request = new XMLHttpRequest(); request.open('GET', c_page, true); request.onload = function () { if (request.readyState == 4 && request.status == 200) { var config_str = request.responseText; var doc = JSON.parse(config_str); dest = doc.for; document.getElementById('module').value = doc.module; document.getElementById('h3').innerHTML = dest == 'relay' ? 'Модуль WiFi-реле - настройка' : 'Модуль WiFi-выключателя - настройка'; document.getElementById('h4').innerHTML = dest == 'relay' ? 'Сетевые идентификаторы реле' : 'Идентификаторы удаленных реле'; var d = document.getElementById('rel_list'); if (dest != 'relay') { document.getElementById('save_last_state').style.display = 'none'; } else { doc.save_state == 1 ? document .getElementById('save_state') .setAttribute('checked', 'checked') : document .getElementById('save_state') .removeAttribute('checked'); } for (var i = 0; i < doc.relays.length; i++) { const lab = document.createElement('label'); lab.innerHTML = dest == 'relay' ? 'Реле №' + String(i + 1) : 'Кнопка №' + String(i + 1); d.append(lab); const inp1 = document.createElement('input'); inp1.type = 'text'; inp1.maxLength = '16'; inp1.className = 'relay'; inp1.placeholder = 'Идентификатор реле'; inp1.addEventListener('input', (event) => { inp1.value = inp1.value.replace(/[^a-zA-Z0-9_/-]/g, ''); btnSaveEnabled(); }); inp1.value = doc.relays[i].name; d.append(inp1); const inp2 = document.createElement('input'); inp2.type = 'text'; inp2.maxLength = '64'; inp2.className = 'descr'; inp2.placeholder = 'Описание реле'; if (dest == 'switch') { inp2.disabled = true; } inp2.addEventListener('input', (event) => btnSaveEnabled()); inp2.value = doc.relays[i].descr; d.append(inp2); } } }; request.send(); } document .getElementById('save_state') .addEventListener('input', btnSaveEnabled); document .getElementById('module') .addEventListener('input', btnSaveEnabled); document.addEventListener('DOMContentLoaded', getConfig); </script> </body></html>)";
\ No newline at end of file
+// файл создан сценарием extras/web/build_pages.py из extras/web/config.html, не редактировать
+
+static const char config_page_etag[] PROGMEM = "\"a0f4bd9a\"";
+static const size_t config_page_gz_len = 2017;
+static const uint8_t config_page_gz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xb5, 0x58, 0xfd, 0x6e, 0xdb, 0xd6,
+    0x15, 0x7f, 0x95, 0x9b, 0x06, 0x28, 0x45, 0x58, 0xa4, 0x3e, 0xec, 0x18, 0x8d, 0x3e, 0x3c, 0xa4,
+    0x89, 0xbb, 0x74, 0x70, 0xea, 0xa0, 0xf6, 0xd6, 0xad, 0x69, 0x66, 0x50, 0xe4, 0x95, 0xc4, 0x86,
+    0x22, 0x35, 0xf2, 0xca, 0xb6, 0x52, 0x04, 0x68, 0xd3, 0x16, 0x1b, 0x90, 0x62, 0xf9, 0x67, 0x18,
+    0x86, 0x61, 0x1b, 0xda, 0x37, 0x70, 0xb3, 0x78, 0xf3, 0x92, 0xc6, 0x7b, 0x05, 0xf2, 0x15, 0xf6,
+    0x24, 0xfb, 0x9d, 0x7b, 0x2f, 0x29, 0x4a, 0x91, 0x55, 0x6f, 0x45, 0x61, 0xc0, 0x22, 0xcf, 0x3d,
+    0xf7, 0xdc, 0x73, 0x7f, 0xe7, 0x77, 0x3e, 0xa4, 0xce, 0x95, 0x5b, 0xbb, 0x37, 0xf7, 0x7f, 0x75,
+    0x77, 0x9b, 0x0d, 0xc5, 0x28, 0xd8, 0xea, 0xc8, 0xff, 0xac, 0x33, 0xe4, 0x8e, 0x87, 0x8f, 0x11,
+    0x17, 0x0e, 0x73, 0xa3, 0x50, 0xf0, 0x50, 0x74, 0x0d, 0xc1, 0x8f, 0x45, 0x8d, 0x14, 0xda, 0xcc,
+    0x1d, 0x3a, 0x71, 0xc2, 0x45, 0xf7, 0xe7, 0xfb, 0xef, 0x58, 0x6f, 0x19, 0xd8, 0x2b, 0xc6, 0x16,
+    0xff, 0xcd, 0xc4, 0x3f, 0xec, 0x1a, 0x5a, 0xdd, 0x12, 0xd3, 0x31, 0x37, 0x58, 0x2d, 0xb7, 0x12,
+    0x3a, 0x23, 0xde, 0x35, 0x7e, 0xf1, 0xee, 0xf6, 0x07, 0x77, 0x77, 0xdf, 0xdf, 0x37, 0x66, 0x56,
+    0x8f, 0x7c, 0x4f, 0x0c, 0xbb, 0x1e, 0x3f, 0xf4, 0x5d, 0x6e, 0xc9, 0x97, 0x2a, 0xf3, 0x43, 0x5f,
+    0xf8, 0x4e, 0x60, 0x25, 0xae, 0x13, 0xf0, 0x6e, 0xc3, 0xae, 0x2b, 0x43, 0x89, 0x98, 0x06, 0x7c,
+    0x8b, 0xf5, 0x22, 0x6f, 0xca, 0x3e, 0x61, 0x23, 0x27, 0x1e, 0xf8, 0x61, 0x8b, 0xd5, 0xdb, 0xac,
+    0x0f, 0x63, 0x56, 0xe2, 0x3f, 0xe4, 0x2d, 0xd6, 0xd8, 0x1c, 0x1f, 0x6b, 0xc1, 0x11, 0xf7, 0x07,
+    0x43, 0xd1, 0x62, 0x1b, 0x75, 0xa8, 0x04, 0x7e, 0xc8, 0xad, 0xa1, 0x96, 0x34, 0xec, 0x6b, 0xb8,
+    0x43, 0x14, 0x44, 0x71, 0x8b, 0x5d, 0x6d, 0x36, 0x9a, 0xd7, 0x9a, 0xd7, 0xdb, 0x8c, 0xae, 0x67,
+    0x39, 0x81, 0x3f, 0x80, 0xcd, 0x80, 0xf7, 0x45, 0x9b, 0xf5, 0x1c, 0xf7, 0xc1, 0x20, 0x8e, 0x26,
+    0xa1, 0x67, 0xe5, 0xca, 0xfd, 0x7e, 0xbf, 0xcd, 0x1e, 0x31, 0x5b, 0x38, 0xbd, 0x04, 0x3e, 0x94,
+    0x0e, 0xc6, 0x19, 0x23, 0xe7, 0x58, 0xdd, 0x40, 0x9e, 0x49, 0x7e, 0x28, 0x1f, 0x2d, 0x32, 0xd7,
+    0x62, 0xce, 0x44, 0x44, 0x85, 0x28, 0x56, 0x9e, 0x28, 0x59, 0x6e, 0x70, 0x8b, 0x0d, 0xd7, 0xe7,
+    0xad, 0x36, 0xde, 0x1a, 0x8b, 0x79, 0xd7, 0x5c, 0xa0, 0xc6, 0x63, 0xda, 0x73, 0x35, 0xe6, 0xc1,
+    0x41, 0xe0, 0x27, 0x02, 0x5b, 0x7a, 0x51, 0xec, 0x71, 0x38, 0xd8, 0x1c, 0x1f, 0xb3, 0x24, 0x0a,
+    0x7c, 0x8f, 0x5d, 0xe5, 0x75, 0xfa, 0x6b, 0xb3, 0xb1, 0xe3, 0x79, 0x7e, 0x38, 0x80, 0x2d, 0xb8,
+    0xc4, 0x1a, 0xd7, 0x0a, 0x7c, 0xca, 0x80, 0x95, 0xad, 0xc1, 0x8b, 0x8d, 0x02, 0x5f, 0xed, 0x7b,
+    0xa3, 0xae, 0xb4, 0x02, 0xa7, 0xc7, 0x83, 0x8b, 0x16, 0xfd, 0x70, 0x3c, 0x11, 0xf7, 0x28, 0xf0,
+    0x8a, 0x2c, 0xc6, 0x7d, 0x68, 0x7a, 0x7e, 0x32, 0x0e, 0x9c, 0x69, 0x8b, 0xf5, 0x82, 0xc8, 0x7d,
+    0x50, 0xdc, 0xbf, 0x17, 0x09, 0x11, 0x8d, 0xf2, 0xbd, 0x4b, 0xcc, 0x69, 0x20, 0xd7, 0xeb, 0xda,
+    0xb8, 0x9d, 0x38, 0x87, 0xfc, 0xa0, 0x27, 0xc2, 0x52, 0xe8, 0x9b, 0x74, 0xa3, 0xe6, 0xb5, 0x92,
+    0x7a, 0xa3, 0x99, 0xab, 0x43, 0xf3, 0x40, 0x82, 0xbc, 0xe8, 0x6d, 0xae, 0xd1, 0xa9, 0x69, 0x3e,
+    0x75, 0x6a, 0x9a, 0xee, 0x44, 0x2c, 0x7c, 0x78, 0xfe, 0x21, 0x73, 0x03, 0x27, 0x49, 0x70, 0x0b,
+    0x44, 0xc5, 0xa0, 0x7c, 0x58, 0x67, 0xbe, 0xd7, 0x35, 0x86, 0xeb, 0xc6, 0x16, 0xb4, 0xd7, 0xb5,
+    0x12, 0x89, 0x72, 0xd4, 0x48, 0x4b, 0x81, 0x43, 0x52, 0xe9, 0x2b, 0x4c, 0x88, 0x83, 0x44, 0x38,
+    0x02, 0x79, 0x20, 0x8f, 0xea, 0x1a, 0xb9, 0xe3, 0x14, 0x05, 0x7d, 0xcf, 0x79, 0x7c, 0xc8, 0x8c,
+    0x84, 0x91, 0x29, 0x18, 0xdd, 0x21, 0x77, 0x1f, 0xf4, 0xa2, 0x63, 0x63, 0x66, 0x76, 0x99, 0x45,
+    0x7d, 0x35, 0x18, 0x94, 0x99, 0x92, 0x7e, 0x93, 0x9e, 0x67, 0x5f, 0x66, 0x9f, 0xa6, 0x27, 0xe9,
+    0xab, 0xec, 0x69, 0xf6, 0x38, 0xfb, 0x8a, 0x65, 0x9f, 0x41, 0xf4, 0x59, 0xf6, 0x18, 0xff, 0x9f,
+    0xa6, 0xaf, 0xd2, 0xb3, 0xf4, 0x94, 0x61, 0xfd, 0x34, 0x7d, 0x89, 0x87, 0xf4, 0xdf, 0x78, 0x3c,
+    0xc3, 0x47, 0x7a, 0x2a, 0x65, 0xff, 0xc4, 0xbe, 0xbf, 0x67, 0x9f, 0x66, 0x9f, 0xe3, 0xe9, 0x45,
+    0x7a, 0xda, 0xa9, 0xa9, 0x8b, 0xe5, 0x37, 0xdc, 0x4a, 0xff, 0x06, 0xd5, 0x33, 0x58, 0x3c, 0xd1,
+    0x96, 0xd2, 0xef, 0xd2, 0xf3, 0xf4, 0x39, 0xf4, 0x5f, 0x66, 0x4f, 0xb5, 0xf6, 0xc2, 0x3d, 0x24,
+    0x1d, 0xe4, 0x1d, 0x46, 0x91, 0x37, 0x09, 0xe0, 0x3f, 0x92, 0x25, 0xe0, 0xe1, 0x00, 0xb9, 0x6f,
+    0x6c, 0x6e, 0x18, 0x0c, 0x18, 0xb8, 0x7c, 0x18, 0x05, 0x60, 0x71, 0xd7, 0x58, 0x79, 0x80, 0xaa,
+    0x05, 0xa0, 0xa8, 0x8c, 0xc8, 0x86, 0x8c, 0xc8, 0x06, 0x45, 0x11, 0x21, 0x59, 0x38, 0xb5, 0x37,
+    0x01, 0xc9, 0x42, 0x83, 0x1d, 0x3a, 0xc1, 0x04, 0xaf, 0xe9, 0x5f, 0x61, 0x90, 0x2e, 0xf7, 0xdc,
+    0xc8, 0x03, 0x9c, 0x93, 0xca, 0x60, 0x51, 0xe8, 0x06, 0xbe, 0xfb, 0xa0, 0xfb, 0xc6, 0x91, 0x1f,
+    0x7a, 0xd1, 0x91, 0x1d, 0x8d, 0x79, 0x58, 0x31, 0x6a, 0x06, 0x5b, 0x63, 0x08, 0x8c, 0x23, 0xfc,
+    0x28, 0xb4, 0x13, 0xee, 0xc4, 0x2e, 0xea, 0x93, 0x71, 0x90, 0xf0, 0xa0, 0x6f, 0x54, 0x59, 0xdf,
+    0x09, 0x12, 0x6e, 0xb6, 0xdf, 0x90, 0x2e, 0x2d, 0x3b, 0x99, 0x7c, 0x24, 0x26, 0xd2, 0x39, 0xaf,
+    0x1d, 0xca, 0x0a, 0x8e, 0xce, 0x5c, 0x2c, 0x45, 0x0e, 0x08, 0x20, 0x72, 0x33, 0xcf, 0x8c, 0x84,
+    0x87, 0xde, 0x2d, 0x47, 0x38, 0x15, 0xd3, 0x20, 0xda, 0x38, 0xbd, 0x80, 0x7b, 0xf2, 0x64, 0x7d,
+    0xf5, 0xc4, 0x8d, 0xfd, 0xb1, 0xd8, 0x82, 0xad, 0x98, 0x79, 0x3c, 0x41, 0xe1, 0xe8, 0x4f, 0x42,
+    0x97, 0x3c, 0x67, 0x92, 0x47, 0xef, 0xa1, 0x06, 0x57, 0x4c, 0xe4, 0x03, 0x29, 0x80, 0xb8, 0xce,
+    0x34, 0x61, 0x5d, 0xe6, 0x45, 0xee, 0x64, 0x84, 0xa2, 0xc2, 0xec, 0x01, 0x17, 0xdb, 0x01, 0xa7,
+    0xe7, 0xb7, 0xa7, 0xef, 0x7a, 0x95, 0x19, 0xb7, 0xcd, 0xf2, 0x5a, 0xf2, 0xf6, 0xf4, 0x26, 0xdd,
+    0x43, 0x5a, 0x33, 0xa4, 0x19, 0xc3, 0xa4, 0x92, 0x12, 0xb3, 0x0a, 0x19, 0xf6, 0x61, 0xb3, 0x5e,
+    0x45, 0x09, 0x0d, 0xf1, 0xa0, 0x4e, 0xb1, 0x55, 0xa4, 0xdb, 0x58, 0xeb, 0xd0, 0x02, 0x1e, 0xd6,
+    0xd6, 0xc8, 0x11, 0xbf, 0xcf, 0x2a, 0x4a, 0xe5, 0x9e, 0x7f, 0xdf, 0x96, 0x18, 0x68, 0x5d, 0xb0,
+    0xad, 0xce, 0xde, 0x7c, 0x93, 0x5d, 0xb0, 0xda, 0x61, 0x9b, 0xb4, 0x1f, 0xed, 0x21, 0x16, 0x15,
+    0x66, 0xa4, 0x7f, 0x00, 0x91, 0xcf, 0x00, 0xd9, 0x09, 0xc3, 0xc7, 0x77, 0xe0, 0xf0, 0x2b, 0x22,
+    0xf4, 0x73, 0xb0, 0xe6, 0x65, 0xfa, 0x0f, 0x25, 0xff, 0x36, 0x7b, 0x22, 0x33, 0x01, 0x6f, 0x92,
+    0x50, 0xa4, 0x73, 0x8a, 0xc7, 0x4d, 0x46, 0xaa, 0x52, 0xf8, 0xad, 0xd4, 0x27, 0x61, 0x63, 0x93,
+    0x32, 0x86, 0x4c, 0x3d, 0x93, 0xb2, 0xf3, 0xf4, 0xd9, 0x15, 0xf6, 0x51, 0xf8, 0x51, 0xc8, 0xd2,
+    0xaf, 0x89, 0x44, 0x94, 0x27, 0xd9, 0xef, 0xa4, 0x8d, 0x57, 0xd9, 0x13, 0x4a, 0xa6, 0x92, 0x76,
+    0xf6, 0x04, 0xa9, 0x68, 0xdb, 0xd7, 0xab, 0xec, 0x86, 0x6d, 0x7f, 0x58, 0x65, 0x8e, 0x6d, 0x3f,
+    0xac, 0x32, 0x8b, 0x55, 0xd9, 0x81, 0xc1, 0x00, 0xd5, 0xec, 0x4e, 0x7d, 0x60, 0x9f, 0x54, 0xa4,
+    0x48, 0x4c, 0xe2, 0x50, 0xf1, 0x89, 0x8a, 0xd3, 0xa3, 0x5c, 0x22, 0xe2, 0x89, 0x14, 0x14, 0x91,
+    0x9c, 0x91, 0x40, 0xe3, 0x77, 0xa5, 0x14, 0x5b, 0x92, 0xa9, 0x8d, 0xb4, 0x27, 0x8f, 0xec, 0x6b,
+    0x81, 0x2d, 0x18, 0x69, 0xda, 0x05, 0x8f, 0xba, 0xcc, 0xc8, 0x9f, 0x8d, 0xb6, 0x64, 0x88, 0x04,
+    0x9c, 0x18, 0x72, 0xef, 0x7e, 0xfb, 0x47, 0xa1, 0x8c, 0xe6, 0xa9, 0x1b, 0xff, 0x70, 0x9b, 0xd2,
+    0xcc, 0xff, 0x4e, 0xc3, 0xb5, 0x35, 0x9f, 0x20, 0x0b, 0xb8, 0x20, 0x15, 0x28, 0x7e, 0x22, 0x07,
+    0x95, 0xd6, 0x22, 0xed, 0xaa, 0xca, 0xcf, 0x96, 0x76, 0xb7, 0x90, 0xb3, 0x47, 0x6d, 0x0d, 0x93,
+    0x3d, 0x9e, 0x24, 0x43, 0xe2, 0xb2, 0x49, 0xc8, 0x93, 0x03, 0xfd, 0x03, 0x0f, 0x61, 0x92, 0x36,
+    0xfb, 0x91, 0xda, 0x2a, 0xaa, 0x4c, 0x95, 0xbf, 0xd6, 0xc5, 0xb1, 0xd1, 0xf5, 0xd1, 0xcc, 0x0f,
+    0x9e, 0xd5, 0xfc, 0x15, 0x9b, 0x4a, 0x8d, 0xc1, 0xb4, 0x25, 0x1f, 0xb8, 0x57, 0xd5, 0x97, 0x68,
+    0x69, 0x0f, 0xab, 0xca, 0xd9, 0x98, 0x1d, 0x0f, 0x63, 0x78, 0x15, 0xf2, 0x23, 0xf6, 0xcb, 0x3b,
+    0x3b, 0xb7, 0x31, 0xba, 0xbd, 0x8f, 0xd1, 0x0d, 0xce, 0x11, 0x0f, 0xb1, 0xa6, 0x2b, 0xdf, 0xdd,
+    0xdd, 0xbd, 0x7d, 0x54, 0x38, 0xa3, 0x96, 0xc4, 0xa8, 0x76, 0x02, 0xf3, 0x5a, 0xdf, 0x1f, 0x40,
+    0x40, 0x84, 0xd4, 0x8a, 0x10, 0xeb, 0xad, 0xb7, 0xd1, 0x40, 0x79, 0x5c, 0x31, 0x6e, 0xea, 0xe1,
+    0x6f, 0x9f, 0x86, 0x3f, 0x6c, 0x96, 0x23, 0xe3, 0xc7, 0x09, 0x2a, 0x61, 0x6e, 0x3b, 0x8c, 0xa1,
+    0x3a, 0x95, 0xae, 0x62, 0x88, 0x0c, 0x07, 0x1c, 0xae, 0x14, 0xdc, 0x96, 0x9c, 0x2e, 0x2e, 0x49,
+    0xed, 0xd8, 0xf6, 0xc3, 0x90, 0xc7, 0xb7, 0xf7, 0xef, 0xec, 0x40, 0x4f, 0x0c, 0xfd, 0xc4, 0x8e,
+    0x79, 0x32, 0x8e, 0xc2, 0x84, 0xef, 0xc3, 0x74, 0x9b, 0xae, 0xa4, 0x3c, 0x09, 0xbd, 0xca, 0xcf,
+    0xf6, 0x76, 0xdf, 0xb3, 0x13, 0x11, 0x63, 0xd8, 0xf1, 0xfb, 0xd3, 0x8a, 0xc2, 0xdf, 0x34, 0xe7,
+    0xb2, 0x07, 0xcc, 0xdf, 0x03, 0x56, 0xdb, 0xa1, 0x24, 0xfa, 0xfc, 0x79, 0x2b, 0xb2, 0x24, 0xe6,
+    0xa3, 0xe8, 0x90, 0xdf, 0x10, 0x30, 0x8e, 0xca, 0x4e, 0x7c, 0xcb, 0x53, 0x65, 0xde, 0x3c, 0x4c,
+    0xdc, 0x94, 0x40, 0x95, 0xca, 0xac, 0x04, 0xe8, 0x42, 0xc0, 0xf5, 0xba, 0x06, 0xfd, 0xa7, 0xdb,
+    0x05, 0xe6, 0x83, 0x02, 0xf3, 0x65, 0x1d, 0x48, 0x47, 0xa1, 0xd8, 0x1d, 0x06, 0x91, 0xe3, 0xbd,
+    0x06, 0xa5, 0x2a, 0xaf, 0x4a, 0x45, 0xe2, 0xbe, 0x47, 0xb8, 0xb3, 0x6e, 0x97, 0x6d, 0xa8, 0xda,
+    0xaa, 0x96, 0x28, 0x1a, 0x93, 0x84, 0xc4, 0xcd, 0x7a, 0x3d, 0x77, 0x5c, 0x1d, 0x0e, 0x52, 0xc5,
+    0x32, 0x7f, 0x72, 0x23, 0x65, 0xf0, 0x65, 0xfe, 0x46, 0x2e, 0xd6, 0x25, 0xf4, 0x63, 0xfa, 0x4e,
+    0x50, 0x99, 0xed, 0x83, 0x7f, 0x9e, 0xba, 0x3a, 0x94, 0x50, 0xea, 0x30, 0xb4, 0x5e, 0x92, 0xf5,
+    0x7a, 0x8b, 0x12, 0xae, 0xd8, 0x85, 0x79, 0xcc, 0x9c, 0x63, 0x88, 0x3a, 0x0f, 0xa5, 0x4c, 0xd5,
+    0x18, 0xf6, 0x13, 0xb4, 0x86, 0xbf, 0x14, 0xa3, 0xc3, 0x57, 0xec, 0x03, 0xff, 0x1d, 0xdf, 0x2a,
+    0xe6, 0x1e, 0x8b, 0xca, 0xfe, 0x09, 0x4d, 0x45, 0x10, 0x9d, 0xa7, 0xff, 0xc2, 0xb0, 0x73, 0x62,
+    0xb0, 0xd6, 0xb2, 0x3d, 0xe9, 0x33, 0x54, 0xf9, 0x17, 0x78, 0xff, 0x7d, 0xf6, 0x5b, 0x6c, 0x79,
+    0x4c, 0x16, 0xb2, 0xa7, 0xcb, 0x2d, 0xac, 0x72, 0x78, 0xe3, 0x12, 0x0e, 0x7f, 0x83, 0xd6, 0x42,
+    0x07, 0x3c, 0x93, 0x8d, 0x05, 0x6d, 0xe5, 0x39, 0xf5, 0x19, 0x88, 0xce, 0xb2, 0x2f, 0xf0, 0xf6,
+    0x42, 0x9e, 0x7f, 0x8e, 0xf9, 0xec, 0x49, 0x31, 0xc2, 0x29, 0xaf, 0xff, 0xb4, 0x4a, 0xf3, 0x73,
+    0x2c, 0x9e, 0xc8, 0xee, 0x26, 0x5b, 0x56, 0xf6, 0xe5, 0x6c, 0xb3, 0x8e, 0x64, 0xa9, 0x08, 0xaf,
+    0xa8, 0xc1, 0x6d, 0xc9, 0x2a, 0xe9, 0xf7, 0x95, 0xc2, 0xef, 0x95, 0x79, 0xb4, 0x38, 0x0c, 0x9b,
+    0xb6, 0x9c, 0x5d, 0x6d, 0x3d, 0xf9, 0x52, 0xe7, 0x09, 0xa3, 0x90, 0x1b, 0x94, 0x49, 0x1c, 0xfd,
+    0x4f, 0xd9, 0xb2, 0x67, 0x35, 0x8d, 0x00, 0x6a, 0x00, 0x9a, 0x8b, 0x5b, 0x44, 0xb9, 0xfe, 0x31,
+    0xaa, 0x4b, 0xa5, 0x54, 0xd5, 0xe5, 0x90, 0xf2, 0x2a, 0x7f, 0x34, 0x59, 0xeb, 0xd2, 0xc6, 0x5e,
+    0x4b, 0xfd, 0xc2, 0x88, 0xcc, 0xfc, 0xb9, 0x76, 0xa3, 0x3a, 0x0b, 0x39, 0xbf, 0xd8, 0x70, 0xd4,
+    0xb8, 0x83, 0xdc, 0x00, 0x6c, 0x98, 0x8f, 0xcb, 0x50, 0xbb, 0xc8, 0x4c, 0xc1, 0xb5, 0x07, 0x15,
+    0x43, 0x4e, 0xcf, 0x64, 0x1c, 0x0f, 0xdf, 0x4b, 0x95, 0xaf, 0x35, 0x93, 0xff, 0xf3, 0xc5, 0x1f,
+    0xa9, 0x4c, 0xec, 0xc9, 0xe2, 0x57, 0xf1, 0xf1, 0xd8, 0x30, 0x25, 0x25, 0xfe, 0x8c, 0x68, 0x9f,
+    0x63, 0x98, 0x06, 0x15, 0x96, 0x2a, 0x81, 0xab, 0xb6, 0x33, 0x1e, 0x53, 0xf9, 0xc4, 0x79, 0x66,
+    0x5b, 0xbb, 0x88, 0x51, 0xb6, 0xb1, 0xc2, 0x47, 0x39, 0xe9, 0x4a, 0x2a, 0x40, 0xcf, 0xa6, 0x89,
+    0x97, 0x82, 0x28, 0x67, 0x7c, 0x2d, 0xc3, 0x74, 0xbf, 0xa3, 0x26, 0x35, 0x2c, 0x34, 0x36, 0x73,
+    0xb1, 0x9b, 0x77, 0x6c, 0x56, 0xdc, 0x43, 0xaf, 0x94, 0xe6, 0x7f, 0x5a, 0xbb, 0x98, 0xcb, 0x65,
+    0xda, 0xca, 0x9d, 0xf8, 0x7a, 0xbb, 0x7d, 0x08, 0xb7, 0x76, 0x40, 0x4f, 0x1e, 0x52, 0x17, 0x52,
+    0xee, 0x55, 0x59, 0x85, 0x93, 0xdc, 0x64, 0xdd, 0x2d, 0xaa, 0x85, 0xa4, 0x9b, 0x57, 0x97, 0xd9,
+    0x0b, 0x22, 0x25, 0x8f, 0xae, 0xd4, 0xee, 0xfd, 0xda, 0xb1, 0x1e, 0xde, 0xb0, 0x3e, 0xac, 0x5b,
+    0xd7, 0x0f, 0x6a, 0xd6, 0xfd, 0xda, 0x00, 0x84, 0xa1, 0x3b, 0x2e, 0xb6, 0x0c, 0x84, 0x3d, 0xbf,
+    0x79, 0xb9, 0x58, 0xcd, 0x26, 0x06, 0x9a, 0x20, 0x4a, 0xb8, 0x92, 0x66, 0x19, 0xd8, 0xe6, 0x25,
+    0x81, 0x6d, 0x2e, 0x01, 0xb6, 0x39, 0x0f, 0x2c, 0xbe, 0x38, 0x69, 0xf1, 0x1c, 0xb0, 0x6a, 0x18,
+    0xd2, 0x2b, 0x8b, 0xc0, 0x2e, 0x7e, 0xb5, 0x2a, 0xc3, 0x99, 0x27, 0x36, 0xb1, 0x2c, 0x39, 0xf2,
+    0x85, 0x3b, 0x94, 0x99, 0x2d, 0xed, 0x94, 0x06, 0xc5, 0x7c, 0x26, 0x95, 0xf2, 0x4b, 0xc1, 0xbf,
+    0x88, 0x61, 0x7e, 0xc3, 0xe5, 0x00, 0x4a, 0xff, 0xe7, 0x11, 0x6c, 0x9a, 0x6a, 0x2a, 0x7e, 0x34,
+    0xeb, 0x79, 0xb2, 0xe7, 0x9b, 0xe5, 0x39, 0xf7, 0xfb, 0x52, 0xf9, 0x62, 0x57, 0xe7, 0xfd, 0x33,
+    0xdb, 0x2b, 0x4c, 0xe6, 0x9d, 0xea, 0xff, 0x32, 0xb7, 0x64, 0xcf, 0xad, 0xdd, 0x3b, 0x7a, 0x6a,
+    0xda, 0x41, 0x0b, 0x97, 0x75, 0xaa, 0x98, 0x22, 0xb0, 0xb3, 0x53, 0xcb, 0xbf, 0xd5, 0x75, 0x6a,
+    0xf2, 0xf7, 0x89, 0x8e, 0xfc, 0x09, 0x6e, 0xeb, 0xbf, 0xa7, 0x56, 0x4c, 0xcd, 0xb9, 0x13, 0x00,
+    0x00,
+};
@@ -2,6 +2,150 @@
 
 #include <Arduino.h>
 
-static const char index_page[] PROGMEM =
-    R"(<!DOCTYPE html><html> <head> <meta content='text/html; charset=UTF-8' http-equiv='content-type' /> <meta name='VIEWPORT' content='width=device-width, initial-scale=1' /> <style> #main { max-width: 400px; margin-left: auto; margin-right: auto; } .switch-list { padding: 25px; } h3 { font-size: 18pt; } .switch-list > h3, .switch-list > h4 { text-align: center; } .cmn-toggle { position: absolute; margin-left: -9999px; visibility: hidden; } .cmn-toggle + label { display: block; position: relative; cursor: pointer; outline: none; user-select: none; padding: 2px; width: 120px; height: 60px; background-color: #dddddd; border-radius: 60px; transition: background 0.2s; } input.cmn-toggle + label:before, input.cmn-toggle + label:after { display: block; position: absolute; content: ''; } input.cmn-toggle + label:before { top: 2px; left: 2px; bottom: 2px; right: 2px; background-color: #fff; border-radius: 60px; transition: background 0.2s; } input.cmn-toggle + label:after { top: 4px; left: 4px; bottom: 4px; width: 52px; background-color: #dddddd; border-radius: 52px; transition: margin 0.2s, background 0.2s; } input.cmn-toggle:checked + label { background-color: #8ce196; } input.cmn-toggle:checked + label:after { margin-left: 60px; background-color: #8ce196; } .switch { display: inline-block; height: 65px; margin-left: 50px; margin-right: auto; margin-top: 10px; margin-bottom: 15px; } .setting { text-align: right; color: black; position: fixed; display: inline-block; top: 90%; right: 10px; font-size: 12px; } #label { display: none; } .button { width: 50px; height: 50px; border-radius: 25px; border-color: #cdcdcd; } .but_link { display: inline-block; padding: 5px 10px; border: solid #cdcdcd 2px; text-decoration: none; border-radius: 10px; margin-left: 90px; } .but_link:hover { background-color: #cdcdcd; } </style> </head> <body> <p id='label'></p> <div id='main'> <div class='switch-list' id='switch-list'> <h3 id='h3'></h3> <h4 id='module'>Описание модуля не задано</h4> </div> <a href='/relay_config' id="relconf" class='setting' >Настройки модуля</a > <a href='/wifi_config' id="wificonf" class='setting' style='top: 95%'>Настройки WiFi</a> </div> <script> var dest; function switchRelay(l_id) { let f_data = { relay: l_id }; var xhr = new XMLHttpRequest(); if (dest == 'relay') { xhr.open('POST', '/relay_switch', true); } else { xhr.open('POST', '/remote_switch', true); } xhr.setRequestHeader('Content-Type', 'text/json'); xhr.onreadystatechange = function () { if (dest == 'relay') { try { document.getElementById('switch-' + l_id).checked = this.responseText == 'on'; } catch (error) {} } }; xhr.send(JSON.stringify(f_data)); } function getConfig() { var c_lab = document.getElementById('label'); var c_page = c_lab.innerHTML; c_lab.innerHTML = ''; var request = new XMLHttpRequest(); request.open('GET', c_page, true); request.onload = function () { if (request.readyState == 4 && request.status == 200) { var config_str = request.responseText; var doc = JSON.parse(config_str); dest = doc.for; if (doc.module != '') { document.getElementById('module').innerHTML = doc.module; document.title = doc.module; } if ((doc.wificonf == '')) { document.getElementById('wificonf').style.display = 'none'; } else { document.getElementById('wificonf').href = doc.wificonf; } document.getElementById('relconf').href = doc.relconf; document.getElementById('h3').innerHTML = dest == 'relay' ? 'Модуль WiFi-реле - управление' : 'Модуль WiFi-выключателя - управление'; var d = document.getElementById('switch-list'); for (var i = 0; i < doc.relays.length; i++) { const d0 = document.createElement('div'); const sp = document.createElement('span'); sp.innerHTML = doc.relays[i].descr; if (sp.innerHTML == '') { sp.innerHTML = 'Описание реле не задано'; } sp.id = 'descr-' + i.toString(); d0.append(sp); const b = document.createElement('br'); d0.append(b); const d1 = document.createElement('div'); d1.className = 'switch'; if (dest == 'relay') { const inp = document.createElement('input'); inp.type = 'checkbox'; inp.id = 'switch-' + i.toString(); inp.className = 'cmn-toggle'; inp.checked = doc.relays[i].last; d1.append(inp); const lab = document.createElement('label'); lab.id = i.toString(); lab.addEventListener('click', (event) => { switchRelay(event.target.id); }); d1.append(lab); } else { const inp = document.createElement('button'); const link = document.createElement('a'); link.innerHTML = ' >>> '; link.className = 'but_link'; link.title = 'Перейти на страницу модуля этого реле'; link.target = '_blank'; inp.id = i.toString(); inp.className = 'button'; inp.innerHTML = (i + 1).toString(); if (doc.relays[i].name == '') { inp.setAttribute('disabled', 'disabled'); link.style.display = 'none'; } else { inp.addEventListener('click', (event) => { switchRelay(event.target.id); }); link.href = 'http://' + doc.relays[i].addr; } d1.append(inp); d1.append(link); } d0.append(d1); d.append(d0); } } }; request.send(); } function getRelayState() { if (dest == 'relay') { var request = new XMLHttpRequest(); request.open('GET', '/relay_getstate', true); request.onload = function () { if (request.readyState == 4 && request.status == 200) { var config_str = request.responseText; var doc = JSON.parse(config_str); for (var i = 0; i < doc.relays.length; i++) { try { document.getElementById('switch-' + i.toString()).checked = doc.relays[i].last; } catch (error) {} } } }; request.send(); } } setInterval(getRelayState, 1000); document.addEventListener('DOMContentLoaded', getConfig); </script> </body></html>)";
+// файл создан сценарием extras/web/build_pages.py из extras/web/index.html, не редактировать
 
+static const char index_page_etag[] PROGMEM = "\"ec23bedb\"";
+static const size_t index_page_gz_len = 2244;
+static const uint8_t index_page_gz[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xd5, 0x59, 0xe9, 0x6e, 0x1c, 0xc7,
+    0x11, 0x7e, 0x95, 0xa6, 0x0d, 0x6b, 0x66, 0x21, 0xee, 0xec, 0x2e, 0x0f, 0x43, 0xda, 0x4b, 0x48,
+    0x64, 0xda, 0x92, 0x21, 0x99, 0x82, 0xc8, 0xc4, 0x09, 0x82, 0x80, 0x98, 0x9d, 0xe9, 0xdd, 0xed,
+    0x70, 0x76, 0x7a, 0x32, 0xdd, 0x4b, 0x72, 0x13, 0x10, 0x88, 0x6d, 0x20, 0xf9, 0x91, 0xeb, 0x05,
+    0x72, 0xbc, 0x82, 0xe0, 0x58, 0x88, 0x1c, 0x25, 0xf2, 0x2b, 0xcc, 0xbe, 0x51, 0xaa, 0xaa, 0x7b,
+    0xae, 0x3d, 0x28, 0x2a, 0xf0, 0x9f, 0x90, 0x80, 0x38, 0x53, 0x5d, 0x77, 0x7d, 0x5d, 0x5d, 0x3d,
+    0xea, 0xef, 0x7c, 0x74, 0xfc, 0xf0, 0xf4, 0xa7, 0xcf, 0x8e, 0xd8, 0x54, 0xcf, 0xa2, 0x61, 0x9f,
+    0xfe, 0x65, 0xfd, 0x29, 0xf7, 0x43, 0xf8, 0x33, 0xe3, 0xda, 0x67, 0x81, 0x8c, 0x35, 0x8f, 0xf5,
+    0xc0, 0xd1, 0xfc, 0x4a, 0xb7, 0x90, 0xa1, 0xc7, 0x82, 0xa9, 0x9f, 0x2a, 0xae, 0x07, 0x3f, 0x3a,
+    0xfd, 0xb8, 0x79, 0xcf, 0x01, 0x59, 0x9d, 0x34, 0xf9, 0x2f, 0xe7, 0xe2, 0x62, 0xe0, 0x58, 0xf6,
+    0xa6, 0x5e, 0x24, 0xdc, 0x61, 0xad, 0x5c, 0x4b, 0xec, 0xcf, 0xf8, 0xc0, 0xf9, 0xf1, 0xe3, 0xa3,
+    0xcf, 0x9f, 0x1d, 0x3f, 0x3f, 0x75, 0x4a, 0xad, 0x97, 0x22, 0xd4, 0xd3, 0x41, 0xc8, 0x2f, 0x44,
+    0xc0, 0x9b, 0xf4, 0xb2, 0xcb, 0x44, 0x2c, 0xb4, 0xf0, 0xa3, 0xa6, 0x0a, 0xfc, 0x88, 0x0f, 0x3a,
+    0x46, 0x8d, 0xd2, 0x8b, 0x88, 0x0f, 0xd9, 0xfb, 0x33, 0x5f, 0xc4, 0xec, 0xd7, 0x6c, 0xe6, 0x5f,
+    0x19, 0xf6, 0x2e, 0x3b, 0x68, 0xb7, 0x93, 0xab, 0x1e, 0x50, 0xd2, 0x89, 0x88, 0x9b, 0x11, 0x1f,
+    0xeb, 0x2e, 0xf3, 0xe7, 0x5a, 0x16, 0xa4, 0x54, 0x4c, 0xa6, 0x05, 0xed, 0x9a, 0x79, 0xea, 0x52,
+    0xe8, 0x60, 0xda, 0x8c, 0x84, 0xd2, 0xa0, 0x29, 0xf1, 0xc3, 0x50, 0xc4, 0x93, 0x2e, 0xdb, 0x3b,
+    0x44, 0x35, 0xd7, 0x6c, 0xba, 0x0f, 0xd4, 0x31, 0x38, 0xd8, 0x54, 0xe2, 0x57, 0xbc, 0xcb, 0x3a,
+    0xf7, 0x12, 0xbd, 0x26, 0x37, 0x04, 0xb6, 0xdd, 0x35, 0xd2, 0x01, 0x48, 0x62, 0x9e, 0x9a, 0x7e,
+    0x24, 0x26, 0x71, 0x97, 0x05, 0x10, 0x23, 0x4f, 0x49, 0x38, 0x98, 0xc5, 0x4d, 0x2d, 0x27, 0x93,
+    0x88, 0xa3, 0x4d, 0xa9, 0x20, 0x44, 0x09, 0x1c, 0xfe, 0x48, 0xc9, 0x68, 0xae, 0xf9, 0x8a, 0xff,
+    0xcd, 0xfb, 0xf0, 0x83, 0xee, 0x5c, 0x08, 0x25, 0x46, 0x22, 0x12, 0x7a, 0xd1, 0x65, 0x53, 0x11,
+    0x86, 0x3c, 0x5e, 0xd5, 0x76, 0x97, 0x45, 0xfe, 0x88, 0x47, 0xa0, 0x35, 0x14, 0x2a, 0x89, 0x7c,
+    0x60, 0x1c, 0x45, 0x32, 0x38, 0xef, 0x55, 0xac, 0xa4, 0x3c, 0xf2, 0xb5, 0xb8, 0x00, 0x2b, 0xc1,
+    0x3c, 0x55, 0x32, 0xed, 0xc2, 0x9a, 0x30, 0xae, 0xc9, 0xb9, 0x8e, 0x44, 0x0c, 0x61, 0xc6, 0x32,
+    0x86, 0xf5, 0xb9, 0xe2, 0x69, 0x53, 0xf1, 0x88, 0x07, 0x3a, 0x27, 0x95, 0x09, 0x42, 0x87, 0x6c,
+    0xd2, 0x3b, 0x7b, 0x94, 0xf4, 0x29, 0x37, 0xb9, 0xfd, 0x90, 0xde, 0x46, 0x7e, 0x70, 0x3e, 0x49,
+    0xe5, 0x3c, 0x0e, 0x9b, 0x81, 0x8c, 0xd0, 0xcc, 0xfb, 0x21, 0xfd, 0xc0, 0x92, 0x4c, 0x43, 0xd0,
+    0x9c, 0xfa, 0xa1, 0x98, 0xab, 0x9c, 0x5f, 0xa7, 0x7e, 0x9c, 0xbb, 0x58, 0xca, 0xb2, 0xb6, 0xb7,
+    0xa7, 0x30, 0x4a, 0x11, 0x27, 0x73, 0xbd, 0x21, 0xd4, 0xee, 0x88, 0x8f, 0x65, 0xca, 0x77, 0xb7,
+    0x33, 0xf8, 0x63, 0x88, 0xed, 0xc6, 0x8c, 0x94, 0x79, 0xb7, 0x50, 0xec, 0x32, 0xc7, 0xb9, 0x85,
+    0x51, 0x2c, 0xb0, 0x4c, 0x6c, 0x2e, 0x4c, 0xad, 0xe8, 0x71, 0x24, 0xb5, 0x96, 0x33, 0xfb, 0x62,
+    0x01, 0xb7, 0xb7, 0x25, 0x27, 0xe3, 0xf1, 0xf8, 0x7b, 0x4e, 0x48, 0x1e, 0x2f, 0xb9, 0x76, 0x50,
+    0xba, 0x76, 0x50, 0x75, 0xed, 0xa0, 0x52, 0xbe, 0xc3, 0xbd, 0x77, 0xab, 0x97, 0xe1, 0xaf, 0xba,
+    0x67, 0xe0, 0x4a, 0xae, 0xed, 0xde, 0xc6, 0xd7, 0x6e, 0x30, 0xe5, 0xc1, 0x39, 0x0f, 0x2b, 0x78,
+    0xdd, 0x60, 0xfe, 0x5e, 0xc0, 0x3b, 0xf7, 0x3f, 0xbc, 0x8d, 0x7c, 0x11, 0x73, 0x6d, 0xdf, 0x6c,
+    0xc5, 0x61, 0xa9, 0xd8, 0xee, 0xd9, 0x2a, 0x3a, 0x44, 0x8c, 0x5b, 0xa0, 0x69, 0x41, 0x52, 0x60,
+    0xfa, 0x70, 0xad, 0xad, 0x1c, 0x56, 0x3b, 0x4d, 0xad, 0xad, 0x58, 0x1a, 0x15, 0xa0, 0x53, 0xe5,
+    0xca, 0xb3, 0xdf, 0xb1, 0xdd, 0xc5, 0x83, 0xc6, 0xa9, 0x61, 0x3b, 0xad, 0x74, 0x0a, 0x52, 0x86,
+    0x60, 0x24, 0x77, 0x47, 0x91, 0x5f, 0x87, 0xeb, 0x58, 0x5c, 0x71, 0xa8, 0xca, 0x16, 0x8f, 0xc9,
+    0xea, 0xfd, 0xf6, 0x07, 0x05, 0xf2, 0x8c, 0x07, 0xd5, 0x1e, 0xb6, 0x67, 0xad, 0x8f, 0xe6, 0xe0,
+    0x0e, 0x36, 0xd0, 0x1c, 0x08, 0xb5, 0x6d, 0x6c, 0xde, 0x56, 0x6a, 0x6f, 0xfa, 0xa2, 0x25, 0xe6,
+    0xf9, 0x0c, 0x42, 0xfc, 0xcd, 0x55, 0x9e, 0x81, 0x37, 0xe7, 0xdb, 0x33, 0x5a, 0x74, 0x10, 0xd0,
+    0x64, 0x7d, 0x33, 0xea, 0xba, 0x0c, 0x76, 0xa1, 0x08, 0x73, 0x75, 0x66, 0xc7, 0x50, 0x5a, 0x42,
+    0x1e, 0xc8, 0xd4, 0x37, 0xc1, 0x9b, 0x36, 0xb4, 0xe2, 0x55, 0x67, 0xbd, 0xe9, 0xdf, 0x6f, 0x97,
+    0x41, 0x92, 0x47, 0xdd, 0xa9, 0xbc, 0x20, 0x8c, 0x6c, 0x00, 0x44, 0x19, 0x40, 0xbf, 0x65, 0xcf,
+    0x96, 0x7e, 0xcb, 0x1e, 0x7c, 0x23, 0x19, 0x2e, 0xe0, 0x4f, 0x28, 0x2e, 0x98, 0x08, 0x07, 0x0e,
+    0x1e, 0x39, 0x8e, 0x7d, 0x0f, 0x22, 0x5f, 0xa9, 0x81, 0x53, 0xe9, 0xfb, 0x0e, 0xf1, 0x54, 0x09,
+    0x78, 0x82, 0xee, 0x13, 0x75, 0xba, 0xef, 0x0c, 0x41, 0xeb, 0x3e, 0x52, 0x0e, 0x8c, 0x2e, 0x19,
+    0xce, 0x23, 0xee, 0x0c, 0xb3, 0xbf, 0x65, 0xdf, 0x65, 0xaf, 0x96, 0x5f, 0x64, 0x2f, 0xb2, 0xff,
+    0x64, 0xaf, 0xb2, 0x97, 0x2c, 0xfb, 0x77, 0xf6, 0x26, 0xfb, 0x66, 0xf9, 0x55, 0xf6, 0x7a, 0xf9,
+    0x67, 0x06, 0x34, 0xa0, 0xfc, 0x13, 0x16, 0xbf, 0x21, 0x86, 0x37, 0xa0, 0xe4, 0x00, 0x1d, 0x04,
+    0x17, 0xe0, 0x8f, 0xcf, 0xa6, 0x29, 0x1f, 0x0f, 0x9c, 0x16, 0xf6, 0xf5, 0xc5, 0x19, 0x74, 0xb0,
+    0xb1, 0x98, 0x90, 0x1f, 0xef, 0x01, 0x05, 0x5f, 0xdf, 0x2b, 0x1c, 0x35, 0x68, 0x73, 0xd8, 0x30,
+    0xfb, 0x6b, 0xf6, 0x62, 0xf9, 0xc5, 0xf2, 0xcb, 0xe5, 0x6f, 0xc0, 0xd0, 0xb7, 0xd9, 0xbf, 0xb2,
+    0x57, 0x35, 0x9b, 0xfd, 0x96, 0xcf, 0xaa, 0xaa, 0x2f, 0xc5, 0x58, 0xd4, 0x34, 0x23, 0x61, 0xb3,
+    0x6a, 0x4a, 0x1f, 0x0c, 0x08, 0x84, 0xc2, 0xc3, 0x0f, 0x9c, 0x4d, 0xa6, 0x3e, 0x17, 0x1f, 0x0b,
+    0x30, 0x51, 0xc6, 0xa0, 0x82, 0x54, 0x24, 0x7a, 0xc8, 0x2e, 0xfc, 0x94, 0x85, 0x5c, 0x01, 0xf6,
+    0xf1, 0x69, 0x24, 0xa5, 0x66, 0x03, 0xd6, 0x36, 0x6f, 0x50, 0x3c, 0x05, 0x08, 0x28, 0x09, 0x89,
+    0x8c, 0xa2, 0x33, 0x2d, 0x66, 0x50, 0xd4, 0x01, 0x8b, 0xe7, 0x11, 0xcc, 0x22, 0xe3, 0x79, 0x1c,
+    0x20, 0x4c, 0x98, 0xa9, 0xc0, 0x73, 0xcc, 0x88, 0x1b, 0x9d, 0x89, 0xb0, 0x01, 0x75, 0x8f, 0xb8,
+    0x66, 0xe3, 0xb3, 0xd0, 0x87, 0x09, 0x64, 0x00, 0xaf, 0x94, 0xae, 0x2e, 0xc3, 0x55, 0x76, 0x6d,
+    0x34, 0x5e, 0x4d, 0x49, 0x15, 0xbf, 0x64, 0x3f, 0x79, 0xfa, 0xe4, 0x11, 0x0c, 0x32, 0xcf, 0x61,
+    0x90, 0x01, 0x77, 0xdc, 0x46, 0x8f, 0x89, 0x31, 0x73, 0xd1, 0x35, 0x36, 0x18, 0x30, 0x87, 0x64,
+    0x1d, 0x54, 0x0a, 0x22, 0x9e, 0x4c, 0x78, 0xec, 0x3a, 0xcf, 0x8e, 0x4f, 0x4e, 0x9d, 0x5d, 0x96,
+    0xd7, 0xc1, 0x78, 0x00, 0x04, 0x9d, 0xce, 0x79, 0x03, 0xa1, 0xc5, 0x23, 0xc5, 0xb7, 0x49, 0xcc,
+    0xa4, 0xe6, 0x1b, 0x44, 0x90, 0x17, 0x32, 0x6b, 0xdd, 0x78, 0x04, 0x80, 0xe4, 0xa9, 0xeb, 0x3c,
+    0xb4, 0x63, 0xd5, 0x29, 0x8e, 0x55, 0x20, 0x4f, 0xc3, 0xd8, 0x2f, 0x94, 0x8c, 0x1d, 0x10, 0x22,
+    0xf5, 0x71, 0x0a, 0xac, 0x0b, 0xa5, 0x7d, 0xcd, 0x61, 0x3c, 0x8b, 0x27, 0x1c, 0xc2, 0x2a, 0x72,
+    0xe3, 0xa2, 0xdf, 0x5b, 0xc2, 0xd1, 0xe9, 0x02, 0x77, 0xae, 0x0c, 0xe6, 0x33, 0xb0, 0xe0, 0x4d,
+    0xb8, 0x3e, 0x8a, 0x38, 0x3e, 0xfe, 0x70, 0xf1, 0x38, 0x74, 0x73, 0x60, 0x3b, 0xd8, 0x77, 0x31,
+    0xab, 0x5e, 0xde, 0x87, 0x07, 0x4c, 0x4f, 0x85, 0xf2, 0x52, 0xae, 0x12, 0x19, 0x2b, 0x7e, 0x0a,
+    0x1e, 0x91, 0x66, 0xf0, 0x09, 0xe3, 0x08, 0x7c, 0x6c, 0xb2, 0x2e, 0x4f, 0x53, 0x99, 0x82, 0x99,
+    0x6b, 0x20, 0x5d, 0xf7, 0x6c, 0x74, 0x71, 0xe8, 0x7e, 0x7a, 0x72, 0xfc, 0x99, 0xa7, 0x74, 0x0a,
+    0x00, 0x12, 0xe3, 0x85, 0x6b, 0x8a, 0xd4, 0xa0, 0x0c, 0x14, 0x5e, 0x83, 0x2b, 0x0f, 0x09, 0x80,
+    0xe4, 0x3e, 0x56, 0x2b, 0x35, 0x59, 0xd9, 0x5a, 0x31, 0xbb, 0x6e, 0x93, 0xfd, 0xc9, 0x91, 0xc9,
+    0xb5, 0x4a, 0xcf, 0x40, 0x55, 0x8e, 0x65, 0x88, 0x43, 0x06, 0xd4, 0x59, 0xc0, 0x13, 0x3f, 0x0d,
+    0xa6, 0x45, 0xf2, 0x0b, 0xe9, 0x38, 0x92, 0x7e, 0xb8, 0x31, 0x7f, 0x39, 0x0b, 0x25, 0xfb, 0x04,
+    0x93, 0x8d, 0x31, 0x1f, 0xb0, 0x3b, 0x77, 0x0a, 0x69, 0x2c, 0xc1, 0x5c, 0x21, 0x79, 0xaf, 0xdd,
+    0xce, 0x1d, 0x37, 0xc6, 0xcf, 0x20, 0x60, 0x50, 0x5b, 0x2a, 0x29, 0x53, 0x67, 0xd0, 0x08, 0x55,
+    0x80, 0x75, 0xca, 0x4d, 0x82, 0x23, 0xb6, 0x5b, 0xca, 0x81, 0x7f, 0xa6, 0x78, 0xc8, 0xe4, 0xc1,
+    0x28, 0x62, 0xf1, 0x09, 0x2f, 0xa6, 0xa7, 0xb0, 0x1d, 0x48, 0x3e, 0x55, 0x74, 0x6b, 0x2d, 0x6d,
+    0xf3, 0x69, 0x78, 0x22, 0x8e, 0x79, 0xfa, 0xe8, 0xf4, 0xe9, 0x13, 0xab, 0xce, 0x2c, 0xf4, 0x4a,
+    0x49, 0x2d, 0x74, 0xc4, 0x57, 0x16, 0xaf, 0xc9, 0x20, 0x59, 0xcc, 0x7b, 0x01, 0x15, 0xdc, 0x69,
+    0xdc, 0x68, 0x34, 0xe7, 0x05, 0xb3, 0xd4, 0x28, 0x3c, 0x7b, 0x48, 0x80, 0x76, 0x07, 0x3b, 0xbb,
+    0x53, 0xd9, 0x28, 0xb7, 0x51, 0x82, 0xfd, 0xc9, 0x7a, 0x96, 0x53, 0x51, 0xc3, 0x56, 0x51, 0xdb,
+    0x11, 0xeb, 0x92, 0x96, 0x08, 0x60, 0x70, 0x1e, 0x40, 0x2e, 0x07, 0x08, 0x0b, 0xd3, 0x85, 0xb6,
+    0xea, 0x81, 0x5e, 0xbe, 0x92, 0xb8, 0xfa, 0x5e, 0x62, 0x0f, 0x98, 0x93, 0xfd, 0xa5, 0x68, 0xa8,
+    0x7f, 0xa0, 0x96, 0xd7, 0x84, 0x16, 0xf8, 0x32, 0x7b, 0x0d, 0xdd, 0xbc, 0xc9, 0x80, 0xfc, 0x1d,
+    0xbc, 0xbe, 0xc8, 0xbe, 0x46, 0x82, 0x69, 0xfb, 0x0e, 0xeb, 0x6e, 0x92, 0xca, 0xbe, 0x5e, 0xfe,
+    0x1e, 0xda, 0xe6, 0xeb, 0xe5, 0x9f, 0x96, 0xbf, 0x83, 0x56, 0xfa, 0x25, 0xea, 0x80, 0x63, 0x61,
+    0x8b, 0x0e, 0x8b, 0x1d, 0x13, 0xda, 0x8d, 0xbb, 0x98, 0x8e, 0xa7, 0x06, 0x4e, 0x06, 0x29, 0x73,
+    0x51, 0x48, 0x98, 0xde, 0x2a, 0x58, 0x3f, 0x4f, 0x8b, 0xbf, 0x50, 0x5e, 0xc4, 0xe3, 0x89, 0x9e,
+    0x02, 0xf9, 0xee, 0x5d, 0x2c, 0x2d, 0x64, 0x0a, 0x22, 0x0d, 0xdb, 0x55, 0x03, 0x01, 0xec, 0x00,
+    0xcd, 0xad, 0x0d, 0xd7, 0x81, 0x9e, 0x8e, 0x7a, 0x0d, 0xa7, 0x4a, 0x6e, 0xe0, 0x54, 0x89, 0x4f,
+    0x4d, 0x4b, 0x25, 0x6b, 0x28, 0x34, 0xd6, 0x7f, 0x26, 0x7e, 0xee, 0x41, 0x6a, 0x03, 0x0b, 0xf0,
+    0x3a, 0x5f, 0x0e, 0xf1, 0x15, 0x69, 0x67, 0xed, 0x38, 0x2d, 0xf2, 0xbe, 0x76, 0x94, 0x12, 0xde,
+    0x50, 0x1e, 0x13, 0xe6, 0x90, 0x25, 0xea, 0x6e, 0xc2, 0xd3, 0xf2, 0x84, 0x1a, 0x12, 0x76, 0x92,
+    0xb0, 0xed, 0xf9, 0x49, 0x82, 0x9d, 0x4a, 0x25, 0x45, 0x60, 0xa3, 0x1b, 0xe2, 0x1a, 0xa5, 0x4e,
+    0x4d, 0x6c, 0x54, 0x48, 0x85, 0x9d, 0xb7, 0x27, 0x2e, 0xec, 0x78, 0x74, 0xaa, 0x7e, 0x06, 0xf7,
+    0x64, 0x74, 0xcb, 0x9e, 0x0b, 0x5b, 0xcf, 0x20, 0xa3, 0x19, 0x66, 0xe4, 0x1b, 0x54, 0xd3, 0x04,
+    0x8d, 0xca, 0xe1, 0xc1, 0xc3, 0xfb, 0x38, 0x2a, 0xa6, 0xee, 0x3d, 0x92, 0x57, 0x8e, 0x21, 0x9b,
+    0x24, 0x54, 0x7a, 0x7c, 0x3d, 0x0b, 0xc8, 0x52, 0xf3, 0xab, 0x9c, 0xc7, 0xad, 0x82, 0xf2, 0x34,
+    0xa8, 0x57, 0x10, 0x84, 0x34, 0x85, 0x65, 0xd3, 0x01, 0xbc, 0x45, 0x42, 0x60, 0x7e, 0xbf, 0xc1,
+    0x6d, 0x9a, 0xee, 0xd1, 0x6d, 0x78, 0x30, 0xfe, 0xd5, 0x7d, 0x42, 0x32, 0xcc, 0x93, 0x47, 0x17,
+    0xc0, 0xfd, 0x04, 0xf0, 0xcc, 0x63, 0x3c, 0x20, 0x83, 0x48, 0x04, 0xe7, 0xd0, 0xed, 0x5d, 0x8e,
+    0xf4, 0x06, 0x1b, 0x0c, 0x11, 0x25, 0x95, 0x91, 0x80, 0xe8, 0x9e, 0x86, 0x79, 0x91, 0x6b, 0x50,
+    0x8b, 0x27, 0x4d, 0xa3, 0xea, 0x20, 0xa8, 0xad, 0x1e, 0xd9, 0xb7, 0x49, 0xb0, 0x99, 0xa5, 0x4b,
+    0xdc, 0xd3, 0x10, 0xbc, 0x9d, 0xdd, 0xa7, 0xa0, 0x80, 0xa7, 0x0e, 0x5d, 0x36, 0x1c, 0x0e, 0x99,
+    0x63, 0x57, 0x6a, 0xc9, 0xce, 0xc7, 0xd8, 0x7c, 0x31, 0x6f, 0xca, 0x4e, 0xf6, 0xf7, 0xec, 0x25,
+    0x01, 0xfc, 0x5b, 0x68, 0x0d, 0xaf, 0x10, 0xe2, 0x2f, 0x98, 0x9d, 0xb7, 0x08, 0xff, 0xcb, 0xdf,
+    0x2e, 0xbf, 0xaa, 0x0f, 0x94, 0xcb, 0x3f, 0x02, 0xe7, 0x9b, 0xec, 0x1f, 0xd9, 0x9b, 0x62, 0x67,
+    0x14, 0x5a, 0x29, 0x25, 0xa8, 0xf6, 0x0c, 0xae, 0x1d, 0x64, 0xad, 0x40, 0xc6, 0x5b, 0xd0, 0x60,
+    0x13, 0x60, 0x05, 0x2a, 0x41, 0xb9, 0x02, 0xa0, 0xd4, 0x69, 0xd4, 0xa5, 0xed, 0x69, 0x55, 0x62,
+    0x24, 0x26, 0x35, 0xf9, 0x96, 0x46, 0x1d, 0x30, 0xf8, 0xfc, 0x40, 0x83, 0x04, 0x28, 0xe6, 0xb8,
+    0x37, 0x94, 0x3f, 0x8a, 0x78, 0x88, 0x87, 0x78, 0xf1, 0x9c, 0xe7, 0xf0, 0xad, 0x67, 0x09, 0xea,
+    0xfb, 0xde, 0x70, 0x42, 0x26, 0xed, 0xf9, 0xe1, 0xe0, 0xf7, 0xae, 0x6e, 0xab, 0x45, 0x67, 0x46,
+    0x2d, 0x20, 0x30, 0x47, 0x1f, 0x7b, 0x56, 0x61, 0x5f, 0x41, 0x19, 0xe8, 0x21, 0x98, 0x95, 0x8d,
+    0x22, 0xec, 0x20, 0x47, 0xf1, 0xd6, 0xa6, 0x65, 0x18, 0x22, 0x52, 0x4d, 0xae, 0x2b, 0x97, 0x08,
+    0xd7, 0xe5, 0x78, 0x42, 0xf3, 0xd3, 0xda, 0xa4, 0x44, 0xde, 0xd3, 0x44, 0x72, 0xd3, 0xb0, 0xf7,
+    0xbf, 0x0f, 0x51, 0x66, 0xc4, 0x05, 0x43, 0x34, 0x62, 0x3e, 0x50, 0x22, 0x0e, 0x38, 0x1d, 0x9b,
+    0xf9, 0x90, 0x0e, 0x47, 0xe9, 0x1d, 0x1c, 0xdf, 0x89, 0x88, 0x0f, 0xff, 0x37, 0x73, 0xd5, 0xbb,
+    0x9d, 0x86, 0xc8, 0x18, 0xaf, 0xf5, 0x3b, 0x7a, 0x02, 0xe7, 0x06, 0x0c, 0x2e, 0x99, 0x7c, 0x0c,
+    0x97, 0xdf, 0x10, 0x06, 0x02, 0x01, 0xc7, 0xfb, 0x06, 0xbe, 0xde, 0x3b, 0x0c, 0xdd, 0x71, 0x65,
+    0x13, 0x35, 0xde, 0xd2, 0x6e, 0x37, 0x4e, 0xdd, 0xf6, 0x4a, 0x85, 0xfc, 0xf8, 0xd8, 0xab, 0xdc,
+    0xaa, 0x90, 0x66, 0xdf, 0xb6, 0x62, 0xac, 0x82, 0x32, 0x02, 0xe5, 0x33, 0xb8, 0x82, 0x91, 0x33,
+    0xb6, 0x72, 0xd5, 0x2b, 0x99, 0xb9, 0x93, 0x35, 0xe8, 0x03, 0x67, 0xe5, 0xa2, 0x06, 0xbb, 0xfa,
+    0x31, 0x7e, 0x6c, 0xbc, 0xf0, 0x23, 0xb7, 0x86, 0xd4, 0x5d, 0xb8, 0xc5, 0xb7, 0xdb, 0xeb, 0x66,
+    0x64, 0x72, 0x83, 0x95, 0x9d, 0xd2, 0x4a, 0x10, 0xc1, 0x00, 0x5f, 0xa8, 0x2e, 0x79, 0x1a, 0xbd,
+    0x4d, 0x37, 0xc5, 0xf5, 0x58, 0xf2, 0x0d, 0x56, 0xdd, 0x2f, 0x3b, 0xb5, 0xfd, 0x92, 0x72, 0x3d,
+    0x4f, 0xe3, 0x7c, 0xf6, 0xdd, 0xb9, 0x14, 0x71, 0x28, 0x2f, 0x3d, 0x92, 0x3b, 0x91, 0xf3, 0x34,
+    0xe0, 0x34, 0x8c, 0xd4, 0xf2, 0xd2, 0xab, 0x08, 0x21, 0x56, 0xb8, 0xb2, 0x3b, 0xad, 0x22, 0xe5,
+    0xe6, 0xfb, 0x89, 0xba, 0x8d, 0xc2, 0xa6, 0xc6, 0x15, 0xec, 0x0f, 0xdc, 0x72, 0x6b, 0xfb, 0xa3,
+    0x96, 0x8f, 0x1e, 0x56, 0x89, 0x78, 0x67, 0x5c, 0x29, 0x7f, 0xe5, 0x9a, 0xc7, 0x73, 0x80, 0xae,
+    0x01, 0x1e, 0x5a, 0x25, 0x5e, 0xb0, 0x6a, 0x60, 0x17, 0x31, 0xf2, 0xbd, 0xdb, 0x1d, 0x50, 0xac,
+    0x60, 0x10, 0xc0, 0x87, 0x75, 0xef, 0x6c, 0xbf, 0xf2, 0x91, 0xb3, 0x44, 0x5b, 0x8b, 0x0c, 0x96,
+    0x82, 0x48, 0x82, 0x77, 0x38, 0x0f, 0xae, 0x24, 0x11, 0x40, 0x73, 0x0a, 0xe5, 0x93, 0x73, 0xed,
+    0x56, 0x6a, 0xb5, 0xcb, 0xf6, 0xdb, 0x16, 0x32, 0xb5, 0xa1, 0x7f, 0xbd, 0xd1, 0x7f, 0x74, 0xfc,
+    0xd4, 0x5e, 0x9a, 0x9f, 0x40, 0xd3, 0xa1, 0x43, 0xa4, 0xb8, 0x4f, 0x82, 0x78, 0xbf, 0x95, 0x7f,
+    0x80, 0xe8, 0xb7, 0xe8, 0x73, 0x4f, 0x9f, 0xfe, 0x6f, 0x63, 0xf8, 0x5f, 0x28, 0xc9, 0x2b, 0x62,
+    0x12, 0x19, 0x00, 0x00,
+};
@@ -2,6 +2,10 @@
 #include <ArduinoJson.h>
 #include "extras/c_page.h"
 #include "extras/i_page.h"
+#include "srConfigSlots.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#endif
 
 #define SR_PRINT(x)         \
   if (logOnState && serial) \
@@ -11,30 +15,39 @@
   serial->println(x)
 
 // ==== имена параметров в запросах/ответах ==========
-static const String sr_name_str = "name";
-static const String sr_command_str = "command";
-static const String sr_response_str = "resp";
-static const String sr_for_str = "for";
-static const String sr_descr_str = "descr";
-static const String sr_relays_str = "relays";
-static const String sr_module_str = "module";
-static const String sr_last_state_str = "last";
-static const String sr_ip_addr_str = "addr";
-static const String sr_wificonf_str = "wificonf";
-static const String sr_relayconf_str = "relconf";
-static const String sr_save_state_str = "save_state";
+static const char sr_name_str[] PROGMEM = "name";
+static const char sr_command_str[] PROGMEM = "command";
+static const char sr_response_str[] PROGMEM = "resp";
+static const char sr_for_str[] PROGMEM = "for";
+static const char sr_descr_str[] PROGMEM = "descr";
+static const char sr_relays_str[] PROGMEM = "relays";
+static const char sr_module_str[] PROGMEM = "module";
+static const char sr_last_state_str[] PROGMEM = "last";
+static const char sr_ip_addr_str[] PROGMEM = "addr";
+static const char sr_wificonf_str[] PROGMEM = "wificonf";
+static const char sr_relayconf_str[] PROGMEM = "relconf";
+static const char sr_save_state_str[] PROGMEM = "save_state";
+static const char sr_proto_str[] PROGMEM = "proto";
+static const char sr_version_str[] PROGMEM = "version";
+static const char sr_since_str[] PROGMEM = "since";
+static const char sr_boot_str[] PROGMEM = "boot";
+static const char sr_state_str[] PROGMEM = "state";
 
 // ==== значения параметров в запросах/ответах =======
-static const String sr_ok_str = "ok";
-static const String sr_no_str = "no";
-static const String sr_on_str = "on";
-static const String sr_off_str = "off";
-static const String sr_relay_str = "relay";
-static const String sr_switch_str = "switch";
-static const String sr_set_on_str = "set_on";
-static const String sr_set_off_str = "set_off";
-static const String sr_respond_str = "respond";
-static const String sr_any_str = "any_relay";
+static const char sr_ok_str[] PROGMEM = "ok";
+static const char sr_no_str[] PROGMEM = "no";
+static const char sr_on_str[] PROGMEM = "on";
+static const char sr_off_str[] PROGMEM = "off";
+static const char sr_relay_str[] PROGMEM = "relay";
+static const char sr_switch_str[] PROGMEM = "switch";
+static const char sr_set_on_str[] PROGMEM = "set_on";
+static const char sr_set_off_str[] PROGMEM = "set_off";
+static const char sr_respond_str[] PROGMEM = "respond";
+static const char sr_subscribe_str[] PROGMEM = "subscribe";
+static const char sr_notify_str[] PROGMEM = "notify";
+static const char sr_any_str[] PROGMEM = "any_relay";
+static const char sr_unknown_str[] PROGMEM = "unknown command";
+static const char sr_empty_str[] PROGMEM = "";
 
 /*
 строка запроса от выключателя - имя реле и команда: отозваться, если идет поиск, или выполнить команду
@@ -44,17 +57,83 @@ static const String sr_any_str = "any_relay";
 строка ответа реле - имя реле, описание, на что отвечает и ответ: состояние реле после выполнения команды или "ok" в случае ответа на поиск;
 {"name":"relay1","descr":"Розетка у окна","for":"switch","resp":"off"}
 {"name":"relay1","descr":"Розетка у окна","for":"respond","resp":"ok"}
+
+выключатель добавляет в команды поле "proto" с версией поддерживаемого бинарного протокола; новое реле в ответ на такую команду отвечает бинарным пакетом, после чего выключатель отправляет этому реле команды только в бинарном виде; старые модули поле "proto" игнорируют и продолжают работать по JSON
+{"name":"relay1","command":"switch","proto":1}
+
+бинарный пакет - заголовок и необязательные поля вида тип-длина-значение:
+[0xA5][версия][код команды][флаги][seq, 2 байта][хэш имени реле FNV-1a, 4 байта][поля...]
+
+seq - порядковый номер команды выключателя (0 - без номера), реле возвращает его в ответе; выключатель повторяет команду, пока не получит ответ с тем же номером, а реле по номеру отбрасывает повторно полученные команды, отвечая текущим состоянием
+
+групповая команда (флаг bfMulti) - один пакет на модуль реле со списком целей; хэш в заголовке не используется, каждая цель - поле pfTarget:
+[хэш имени реле, 4 байта][код команды]
+реле выполняет все команды и отвечает одним пакетом с флагами bfReply | bfMulti, в котором для каждой цели передается поле pfTarget:
+[хэш имени реле, 4 байта][состояние реле, SrResponse]
+
+подписка на изменения состояния реле: выключатель, отправивший реле команду или команду "subscribe", на время аренды становится подписчиком модуля реле; каждое изменение состояния реле (в т.ч. кнопкой или через Web-интерфейс) рассылается подписчикам уведомлением - ответом на команду "notify"; бинарным подписчикам все изменения за один вызов tick() передаются одним пакетом в формате ответа на групповую команду
+{"name":"relay1","descr":"Розетка у окна","for":"notify","resp":"on"}
 */
 
+// ==== бинарный протокол ============================
+static const uint8_t SR_BIN_MAGIC = 0xA5;     // первый байт бинарного пакета, JSON-строка так начинаться не может
+static const uint8_t SR_PROTO_VERSION = 1;    // версия бинарного протокола
+static const uint8_t SR_BIN_HEADER_SIZE = 10; // размер заголовка бинарного пакета
+
+// коды команд; в бинарных пакетах передаются как есть
+enum SrCommand : uint8_t
+{
+  cmUnknown,
+  cmRespond,
+  cmSwitch,
+  cmSetOn,
+  cmSetOff,
+  cmSubscribe, // подписка на уведомления об изменении состояния реле
+  cmNotify     // уведомление об изменении состояния реле, передается только в ответах
+};
+
+// коды ответа реле (состояние реле или результат выполнения команды)
+enum SrResponse : uint8_t
+{
+  rsOff,
+  rsOn,
+  rsOk,
+  rsUnknown
+};
+
+// флаги пакета
+enum BinFlag : uint8_t
+{
+  bfReply = 0x01,   // пакет является ответом реле
+  bfAnyRelay = 0x02, // команда для всех реле модуля
+  bfMulti = 0x04     // групповая команда или ответ на нее, цели перечислены в полях pfTarget
+};
+
+// необязательные поля пакета
+enum PacketField : uint8_t
+{
+  pfName = 1, // имя реле
+  pfDescr,    // описание реле или модуля
+  pfResp,     // ответ реле, один байт SrResponse
+  pfTarget,   // цель групповой команды: хэш имени реле, 4 байта, и код команды или ответа
+  pfSession   // сеанс отправителя команды, 4 байта; новый после каждой перезагрузки и у каждого экземпляра модуля
+};
+
+static const uint8_t SR_BIN_TARGET_SIZE = 5; // размер данных поля pfTarget
+
 static const char TEXT_PLAIN[] PROGMEM = "text/plain";
 static const char TEXT_HTML[] PROGMEM = "text/html";
 static const char TEXT_JSON[] PROGMEM = "text/json";
 static const char RELAY_GET_CONFIG[] PROGMEM = "/relay_getconfig";
 static const char SWITCH_GET_CONFIG[] PROGMEM = "/switch_getconfig";
 static const char SR_SET_CONFIG[] PROGMEM = "/sr_setconfig";
+static const char SR_GET_CONFIG[] PROGMEM = "/sr_getconfig"; // настройки модуля для страниц Web-интерфейса
 static const char RELAY_GET_STATE[] PROGMEM = "/relay_getstate";
+static const char RELAY_EVENTS[] PROGMEM = "/relay_events";
 static const char RELAY_SWITCH[] PROGMEM = "/relay_switch";
 static const char REMOTE_RELAY_SWITCH[] PROGMEM = "/remote_switch";
+static const char RELAY_SET_STATES[] PROGMEM = "/relay_setstates";
+static const char REMOTE_SET_STATES[] PROGMEM = "/remote_setstates";
 
 // константы для работы с JSON
 #if defined(ARDUINO_ARCH_ESP8266)
@@ -70,64 +149,394 @@ enum ModuleType : uint8_t
   mtSwitch
 };
 
+// данные udp-пакета, разобранные за один проход
+struct srMessage
+{
+  String name;       // имя реле
+  String descr;      // описание реле или модуля
+  uint8_t command;   // команда, SrCommand
+  uint8_t forComm;   // команда, на которую дан ответ, SrCommand
+  uint8_t response;  // ответ реле, SrResponse
+  bool anyRelay;     // команда для всех реле модуля
+  uint32_t nameHash; // хэш имени реле (для бинарных пакетов)
+  uint8_t proto;     // версия бинарного протокола, поддерживаемая отправителем
+  bool binary;       // пакет получен в бинарном виде
+  bool reply;        // пакет является ответом реле
+  uint16_t seq;      // порядковый номер команды; 0 - без номера
+  uint32_t session;  // сеанс отправителя команды; 0 - не передан
+  bool duplicate;    // команда с этим номером уже была выполнена
+  const uint8_t *targets; // данные полей pfTarget групповой команды, указывают в буфер принятого пакета
+  uint8_t targetCount;    // количество целей групповой команды
+  srMessage() : command(cmUnknown),
+                forComm(cmUnknown),
+                response(rsUnknown),
+                anyRelay(false),
+                nameHash(0),
+                proto(0),
+                binary(false),
+                reply(false),
+                seq(0),
+                session(0),
+                duplicate(false),
+                targets(NULL),
+                targetCount(0) {}
+};
+
+// хэш-индекс имен реле; открытая адресация с линейным пробированием
+struct srNameIndex
+{
+  int16_t *slots; // индексы реле в массиве; -1 - свободная ячейка
+  uint16_t size;  // количество ячеек, степень двойки
+  srNameIndex() : slots(NULL), size(0) {}
+};
+
+// маски реле, по биту на реле
+static const uint16_t SR_MASK_SIZE = SR_MAX_RELAY_COUNT / 8;
+
+// таблица реле из блоков по SR_TABLE_CHUNK записей; при росте таблицы выделяются только новые блоки,
+// а уже добавленные записи не перемещаются, поэтому ссылки на них остаются действительными
+static const uint8_t SR_TABLE_CHUNK = 8;
+
+template <typename T>
+struct srTable
+{
+  T **chunks = NULL;       // блоки записей
+  uint16_t chunkCount = 0; // количество выделенных блоков
+
+  T &operator[](int16_t index) { return (chunks[index / SR_TABLE_CHUNK][index % SR_TABLE_CHUNK]); }
+
+  // увеличение таблицы до _count записей; false - не хватило памяти
+  bool reserve(uint16_t _count)
+  {
+    uint16_t need = (_count + SR_TABLE_CHUNK - 1) / SR_TABLE_CHUNK;
+    if (need <= chunkCount)
+    {
+      return (true);
+    }
+
+    T **list = new T *[need];
+    if (!list)
+    {
+      return (false);
+    }
+    for (uint16_t i = 0; i < chunkCount; i++)
+    {
+      list[i] = chunks[i];
+    }
+    uint16_t n = chunkCount;
+    while (n < need && (list[n] = new T[SR_TABLE_CHUNK]) != NULL)
+    {
+      n++;
+    }
+    delete[] chunks;
+    chunks = list;
+    chunkCount = n;
+
+    return (n == need);
+  }
+};
+
 // ==== общие данные =================================
 
-static shRelayData *relayArray = NULL;
-static int8_t relayCount = 0;
-static String relayFileConfigName = "/relay.json";
+// журнал состояния реле - файл из записей фиксированной длины, которые только дописываются в конец;
+// запись: [индекс реле][старшие биты индекса и состояние][порядковый номер][контрольный байт];
+// состояние - младший бит второго байта, поэтому записи старого формата (индекс до 127) читаются так же;
+// перед записями - заголовок: ['J'][номер версии файла настроек, 4 байта][контрольный байт]; журнал
+// дополняет только ту версию настроек, номер которой указан в заголовке
+static const uint8_t SR_JOURNAL_RECORD_SIZE = 4;
+static const uint8_t SR_JOURNAL_HEADER_SIZE = 6;
+static const uint8_t SR_JOURNAL_CHECK = 0x5A;
+static const uint16_t SR_JOURNAL_MAX_RECORDS = 128; // после этого журнал переносится в файл настроек и очищается
+
+// подсчет crc32 и длины сериализуемого JSON без буфера
+class srCrcPrint : public Print
+{
+public:
+  uint32_t crc = 0xFFFFFFFF;
+  size_t len = 0;
+
+  size_t write(uint8_t c)
+  {
+    crc = sr_crc32_update(crc, c);
+    len++;
+    return (1);
+  }
+
+  uint32_t getCrc() { return (~crc); }
+};
+
+// строка как поток, чтобы тело запроса разбиралось так же, как файл настроек - по одному реле
+class srStringStream : public Stream
+{
+private:
+  const String &str;
+  size_t pos = 0;
+
+public:
+  srStringStream(const String &_str) : str(_str) { setTimeout(0); }
+
+  int available() { return (str.length() - pos); }
+  int read() { return ((pos < str.length()) ? (uint8_t)str[pos++] : -1); }
+  int peek() { return ((pos < str.length()) ? (uint8_t)str[pos] : -1); }
+  size_t write(uint8_t) { return (0); }
+  void flush() {}
+};
+
+// вывод в строку с дописыванием в конец; serializeJson() прямо в String в зависимости от версии
+// ArduinoJson может заменить ее содержимое
+class srStringPrint : public Print
+{
+private:
+  String &str;
 
-static shSwitchData *switchArray = NULL;
-static int8_t switchCount = 0;
-static String switchFileConfigName = "/switch.json";
+public:
+  srStringPrint(String &_str) : str(_str) {}
 
-static String module_description = "";
-static bool save_state_of_relay = false;
+  size_t write(uint8_t c)
+  {
+    str += (char)c;
+    return (1);
+  }
+};
 
 static Print *serial = NULL;
 static bool logOnState = true;
 
-static shWebServer *http_server = NULL;
-static FS *file_system = NULL;
-static WiFiUDP *udp = NULL;
-static uint16_t localPort = 0;
+// буфер исходящего udp-пакета; пакеты собираются прямо в нем, без выделения памяти в куче
+static uint8_t packet_buf[RELAY_DATA_SIZE];
+
+static const uint8_t SR_NAMED_PROBE_MAX = 4; // при большем количестве ненайденных реле запрос отправляется для всех реле
+static const uint8_t SR_MULTICAST_MISSES = 3;       // после стольких запросов в группу без ответа используется широковещательный адрес
+static const uint32_t SR_MULTICAST_RETRY = 600000; // через сколько после перехода на широковещательный адрес снова пробовать группу
+
+// окно уже выполненных команд для каждого отправителя, чтобы повторы не выполнялись дважды;
+// отправитель - адрес и сеанс, поэтому после перезагрузки выключателя, начинающего нумерацию
+// заново, и для нескольких выключателей одной прошивки окна разные
+static const uint8_t SR_DEDUPE_SENDERS = 8;
+static const uint32_t SR_DEDUPE_TTL = 60000; // окно отправителя, молчащего дольше, освобождается
+struct srSenderWindow
+{
+  IPAddress address;
+  uint32_t session = 0; // сеанс отправителя; 0 - отправитель не передает сеанс
+  uint16_t lastSeq = 0; // старший принятый номер команды
+  uint16_t window = 0;  // биты принятых номеров: бит 0 - lastSeq, бит n - lastSeq - n; 0 - окно свободно
+  uint32_t time = 0;    // время последней команды, для вытеснения самого старого отправителя
+};
+
+// подписчики на уведомления об изменении состояния реле
+static const uint8_t SR_MAX_SUBSCRIBERS = 8;
+struct srSubscriber
+{
+  IPAddress address;
+  uint32_t time = 0;   // время последнего продления подписки
+  bool binary = false; // подписчик понимает бинарный протокол
+  bool active = false;
+};
+
+// клиенты Web-интерфейса, получающие изменения состояния реле потоком Server-Sent Events
+static const uint8_t SR_MAX_EVENT_CLIENTS = 4;
+static const uint32_t SR_EVENT_KEEPALIVE = 15000; // интервал пустых сообщений, по которым выявляются отключившиеся клиенты
+static const uint32_t SR_EVENT_WRITE_TIMEOUT = 500; // ожидание отправки состояния всех реле при подключении клиента, мс
+
+// ==== данные экземпляра модуля =====================
+
+// у каждого экземпляра shRelayControl и shSwitchControl свои данные, поэтому в одной прошивке
+// могут работать и модуль реле, и модуль выключателя, и несколько групп реле на разных портах
+struct srContext
+{
+  ModuleType type;
+  std::function<void(srMessage &)> onMessage; // обработчик пакетов, полученных через общий udp-сокет
+
+  srTable<shRelayData> relayArray;
+  int16_t relayCount = 0;
+  String relayFileConfigName = "/relay.json";
+
+  srTable<shSwitchData> switchArray;
+  int16_t switchCount = 0;
+  String switchFileConfigName = "/switch.json";
+
+  srNameIndex relayNameIndex;
+  srNameIndex switchNameIndex;
+
+  String module_description = "";
+  bool save_state_of_relay = false;
+  bool relay_state_dirty = false;   // состояние реле изменилось, но еще не сохранено
+  uint32_t save_state_delay = 3000; // интервал, в течение которого накапливаются изменения состояния реле
+  uint32_t save_state_timer = 0;    // время первого несохраненного изменения
+  uint32_t state_version = 0;       // растет при каждом изменении состояния любого реле
+  uint32_t boot_id = 0;             // выбирается случайно при запуске; версии состояния имеют смысл только вместе с ним
+
+  // теневой регистр состояния реле, по биту на реле; текущее состояние реле берется только отсюда,
+  // на выходы оно переносится в commit_relay_outputs()
+  uint8_t relay_state[SR_MASK_SIZE] = {0};
+  uint8_t output_mask[SR_MASK_SIZE] = {0}; // реле, состояние которых еще не перенесено на выходы
+  bool output_batch = false;     // изменения накапливаются и переносятся на выходы одной записью
+
+  uint16_t journal_records = 0;
+  uint8_t journal_seq = 0;
+  bool journal_header = false; // заголовок журнала уже записан
+  bool journal_failed = false; // запись в журнал не удалась, в конце журнала может остаться недописанная запись
+
+  uint32_t config_seq[2] = {0, 0};  // номер последней сохраненной версии, по типу модуля
+  int8_t config_slot[2] = {-1, -1}; // слот с последней версией, по типу модуля
+
+  shWebServer *http_server = NULL;
+  FS *file_system = NULL;
+  WiFiUDP *udp = NULL;
+  uint16_t localPort = 0;
+  // группа multicast для поиска реле и команд для всех реле; 0.0.0.0 - используется широковещательный адрес
+  IPAddress multicast_group = IPAddress(0, 0, 0, 0);
+  bool multicast_joined = false;
+  IPAddress multicast_ip = IPAddress(0, 0, 0, 0); // адрес модуля при входе в группу; 0.0.0.0 - нет подключения к WiFi
+  bool multicast_probe = false;         // запрос поиска всех реле отправлен в группу, ответа на него еще не было
+  bool broadcast_probe = false;         // то же для широковещательного запроса после отказа от группы
+  uint8_t multicast_misses = 0;         // проверки подряд, при которых на запросы в группу никто не ответил
+  uint32_t multicast_fallback_timer = 0; // время перехода на широковещательный адрес
+
+  shBuzzer bzr;
+
+  String wifi_config_page = "";
+  String relay_config_page = "";
+
+  // подтверждение команд выключателя
+  uint32_t session = 0;           // сеанс, передается с каждой командой; выбирается случайно при запуске
+  uint16_t command_seq = 0;       // номер последней отправленной команды
+  uint8_t command_retries = 3;    // количество повторов неподтвержденной команды
+  uint16_t command_timeout = 100; // время ожидания подтверждения до первого повтора, мс
+
+  // доступность удаленных реле
+  uint32_t relay_ttl = 90000; // срок, после которого не отвечающее реле считается ненайденным
+
+  srSenderWindow sender_window[SR_DEDUPE_SENDERS];
+
+  srSubscriber subscribers[SR_MAX_SUBSCRIBERS];
+  uint32_t subscription_lease = 120000; // срок аренды подписки
+  uint8_t notify_mask[SR_MASK_SIZE] = {0}; // реле, изменения которых еще не разосланы, по биту на реле
+  bool notify_pending = false;
+  bool subscribe_state = true; // выключатель подписывается на уведомления найденных реле
+
+  WiFiClient event_clients[SR_MAX_EVENT_CLIENTS];
+  uint32_t event_timer = 0;
+
+  srContext(ModuleType _type) : type(_type) {}
+};
+
+// данные экземпляра, с которым идет работа; выбираются при входе в каждый метод классов,
+// в обработчиках запросов Web-сервера и при разборе udp-пакетов
+static srContext *ctx = NULL;
 
-static shBuzzer bzr;
+// модули, получающие пакеты через общие udp-сокеты; пакет, принятый любым из них, разбирается
+// один раз и передается всем модулям того же сокета: ответы реле - выключателям, остальное - реле
+static const uint8_t SR_MAX_UDP_MODULES = 4;
+static srContext *udp_modules[SR_MAX_UDP_MODULES];
 
-static String wifi_config_page = "";
-static String relay_config_page = "";
+// драйвер выходов для реле, подключенных к пинам самого модуля; общий для всех экземпляров
+static srGpioDriver gpio_driver;
 
 // ===================================================
 
 static IPAddress get_broadcast_address();
+static IPAddress get_discovery_address();
+static bool is_multicast_address(const IPAddress &address);
+static bool join_multicast_group();
+static void check_multicast_group();
+static void check_multicast_replies();
+static void receive_discovery_reply();
+static void idle_pause(bool _busy, uint8_t _delay);
+static void add_udp_module(srContext *_ctx);
+static bool receive_udp_packets(WiFiUDP *_udp, uint8_t _max_packets, uint16_t _max_time);
+static bool decode_udp_packet(char *buf, size_t bufSize, srMessage &msg);
+static bool decode_bin_packet(const uint8_t *buf, size_t bufSize, srMessage &msg);
+static uint32_t get_bin_uint32(const uint8_t *buf);
+static void set_bin_uint32(uint8_t *buf, uint32_t _value);
+static uint32_t get_name_hash(const char *_name);
+static void build_name_index(ModuleType _mdt);
+static int16_t get_free_slot(ModuleType _mdt);
+static int16_t find_in_name_index(ModuleType _mdt, uint32_t _hash, const char *_name);
+static uint8_t get_command_code(const char *_comm);
+static const __FlashStringHelper *get_command_str(uint8_t _comm);
+static uint8_t get_response_code(const char *_resp);
+static const __FlashStringHelper *get_response_str(uint8_t _resp);
+static const __FlashStringHelper *get_state_str(bool _state);
+static size_t get_bin_packet_to_send(uint8_t *buf,
+                                     size_t bufSize,
+                                     uint8_t _op,
+                                     uint8_t _flags,
+                                     uint16_t _seq,
+                                     uint32_t _hash);
+static size_t add_bin_field(uint8_t *buf,
+                            size_t pos,
+                            size_t bufSize,
+                            uint8_t _field,
+                            const uint8_t *data,
+                            size_t len);
+static void send_response(const IPAddress &address,
+                          const String &_name,
+                          const String &_descr,
+                          uint8_t _resp,
+                          uint8_t _for,
+                          bool _binary,
+                          uint16_t _seq);
 static bool get_value_of_argument(String &_res, const String &_arg, String &_str);
-static bool send_udp_packet(const IPAddress &address, const char *buf, size_t bufSize);
+static bool send_udp_packet(const IPAddress &address, const uint8_t *buf, size_t bufSize);
 static String get_argument(String &_res, const String &_arg);
-static String get_json_string_to_send(const String &_name, const String &_comm);
-static String get_json_string_to_send(const String &_name,
+static size_t get_json_packet_to_send(uint8_t _comm);
+static size_t get_json_packet_to_send(const String &_name, uint8_t _comm);
+static size_t get_json_packet_to_send(const String &_name,
                                       const String &_descr,
-                                      const String &_comm,
-                                      const String &_for);
-
-static void switch_local_relay(int8_t index);
-static void set_local_relay_state(int8_t index, bool state);
-static String get_relay_state(int8_t index);
-
-static void switch_remote_relay(int8_t index);
-static void set_remote_relay_state(int8_t index, bool state);
+                                      uint8_t _resp,
+                                      uint8_t _for);
+
+static void switch_local_relay(int16_t index);
+static void set_local_relay_state(int16_t index, bool state);
+static bool apply_local_command(int16_t index, uint8_t comm);
+static void apply_multi_command(const srMessage &msg);
+static bool get_relay_state(int16_t index);
+static void commit_relay_outputs();
+static srRelayDriver *get_relay_driver(int16_t index);
+static bool flush_relay_state(bool _force);
+static void mark_relay_state_saved();
+static String get_journal_file_name();
+static bool append_relay_journal();
+static bool replay_relay_journal();
+static void clear_relay_journal();
+static void get_journal_header(uint8_t *hdr);
+
+static void switch_remote_relay(int16_t index);
+static void set_remote_relay_state(int16_t index, bool state);
 static void set_all_remote_relay_state(bool state);
-static void send_command_for_relay(int8_t index, const String &command);
+static void send_command_for_relay(int16_t index, uint8_t command);
+static void send_multi_command(const uint8_t *mask, const uint8_t *states);
+static uint16_t get_next_command_seq();
+static void send_bin_command(int16_t index);
+static bool retry_pending_commands();
+static void confirm_command(int16_t index, uint16_t _seq);
+static bool is_duplicate_command(const IPAddress &address, uint32_t _session, uint16_t _seq);
+static uint32_t get_random_uint32();
+static void add_subscriber(const IPAddress &address, bool _binary);
+static void notify_subscribers();
+static void publish_relay_changes();
+static void send_relay_events(bool _keepalive);
+static bool write_relay_event(WiFiClient &client, const String &data);
+static void send_subscribe(int16_t index);
+static void set_remote_state(int16_t index, uint8_t _resp);
 
 static void find_remote_relays();
+static void check_remote_relays(uint32_t _interval);
+static void send_relay_probe(int16_t index, const IPAddress &address);
+static void mark_relay_seen(int16_t index);
+static bool find_local_relay(int16_t index);
+static void send_local_command(int16_t index, uint8_t command);
+static void receive_relay_response(int16_t index, uint8_t _resp, uint16_t _seq);
 
 // ===================================================
-static void handleGetConfigPage(String arg, String page);
-static void handleGetRelayConfigPage();
-static void handleGetSwitchConfigPage();
-
-static void handleGetRelayIndexPage();
-static void handleGetSwitchIndexPage();
+static void add_web_handler(const String &_uri, HTTPMethod _method, void (*_handler)());
+static void collect_page_headers();
+static void send_gz_page(const uint8_t *page, size_t len, PGM_P etag);
+static void handleGetConfigPage();
+static void handleGetIndexPage();
 
-static void handleGetConfig(String _msg);
+static void send_relays_json(ModuleType _mdl, bool _config, uint32_t _since);
 static void handleGetRelayConfig();
 static void handleGetSwitchConfig();
 
@@ -139,33 +548,49 @@ static void get_relay_data_json(JsonObject &rel,
                                 const String &_name,
                                 const String &_descr,
                                 const IPAddress _ip);
-static void get_config_json_doc(DynamicJsonDocument &doc, ModuleType _mdl);
-static String get_config_json_string(ModuleType _mdl);
+static size_t write_config_json(Print &out, ModuleType _mdl);
 
+static srContext *get_web_module(const char *_for);
+static void handleGetModuleConfig();
 static void handleSetConfig();
 
 static void handleRelaySwitch();
 static void handleRemoteRelaySwitch();
+static bool get_bulk_states(uint8_t *mask, uint8_t *states, int16_t count);
+static void handleRelaySetStates();
+static void handleRemoteSetStates();
 static void handleGetRelayState();
+static void handleRelayEvents();
 
 // ===================================================
-static bool load_setting(ModuleType _mdt, DynamicJsonDocument &doc);
+static DeserializationError read_config_params(JsonDocument &doc, Stream &in);
+static int skip_spaces(Stream &in);
+static bool skip_json_string(Stream &in, PGM_P _match);
+static bool skip_json_value(Stream &in);
+static bool find_relays_array(Stream &in);
+static int8_t read_relay_item(JsonDocument &doc, Stream &in, bool _first);
+static bool load_setting(ModuleType _mdt, JsonDocument &doc, Stream &in);
 
 static String get_config_file_name(ModuleType _mdt);
+static String get_config_slot_name(ModuleType _mdt, uint8_t _slot);
+static bool check_config_slot(const String &fileName, uint32_t &_seq, size_t &_offset);
+static int8_t find_config_slot(ModuleType _mdt, size_t &_offset);
 static bool save_config_file(ModuleType _mdt);
-static bool save_config_file(ModuleType _mdt, DynamicJsonDocument &doc);
 static bool load_config_file(ModuleType _mdt);
 
 // ==== shRelayControl class ===========================
 
-shRelayControl::shRelayControl() {}
+shRelayControl::shRelayControl() { context = new srContext(mtRelay); }
 
-void shRelayControl::init(uint8_t _relay_count)
+void shRelayControl::init(uint16_t _relay_count)
 {
-  relayArray = new shRelayData[_relay_count];
-  if (relayArray)
+  if (_relay_count > SR_MAX_RELAY_COUNT)
   {
-    relayCount = _relay_count;
+    _relay_count = SR_MAX_RELAY_COUNT;
+  }
+  if (context->relayArray.reserve(_relay_count))
+  {
+    context->relayCount = _relay_count;
   }
 
   if (&Serial != NULL)
@@ -178,26 +603,27 @@ bool shRelayControl::addRelay(const String &relay_name,
                               uint8_t relay_pin,
                               uint8_t control_level,
                               srButton *relay_button,
-                              const String &relay_description)
+                              const String &relay_description,
+                              srRelayDriver *relay_driver)
 {
+  ctx = context;
   bool result = false;
-  if (relayCount > 0)
+  srRelayDriver *drv = (relay_driver) ? relay_driver : &gpio_driver;
+  int16_t index = (relay_pin < drv->getChannelCount()) ? get_free_slot(mtRelay) : -1;
+  if (index >= 0)
   {
-    for (uint8_t i = 0; i < relayCount; i++)
-    {
-      if (relayArray[i].relayName == "")
-      {
-        relayArray[i] = shRelayData(relay_name,
-                                    relay_pin,
-                                    control_level,
-                                    relay_button,
-                                    relay_description);
-        digitalWrite(relay_pin, !control_level);
-        pinMode(relay_pin, OUTPUT);
-        result = true;
-        break;
-      }
-    }
+    context->relayArray[index] = shRelayData(relay_name,
+                                             relay_pin,
+                                             control_level,
+                                             relay_button,
+                                             relay_description,
+                                             relay_driver);
+    drv->attachChannel(relay_pin, !control_level);
+    result = true;
+  }
+  if (result)
+  {
+    build_name_index(mtRelay);
   }
   return (result);
 }
@@ -212,278 +638,439 @@ bool shRelayControl::getLogOnState() { return (logOnState); }
 
 void shRelayControl::setButtonBuzzerState(bool _state, int8_t _pin)
 {
-  bzr.setState(_state, _pin);
+  context->bzr.setState(_state, _pin);
 }
 
 void shRelayControl::setBtnBeepData(uint16_t _freq, uint32_t _dur)
 {
-  bzr.setBtnBeepData(_freq, _dur);
+  context->bzr.setBtnBeepData(_freq, _dur);
 }
 
 void shRelayControl::startDevice(WiFiUDP *_udp, uint16_t _local_port)
 {
-  udp = _udp;
-  localPort = _local_port;
+  ctx = context;
+  context->udp = _udp;
+  context->localPort = _local_port;
+  context->onMessage = [this](srMessage &msg)
+  { receiveUdpPacket(msg); };
+  add_udp_module(context);
+  join_multicast_group();
+}
+
+void shRelayControl::setMulticastGroup(const IPAddress &_group)
+{
+  ctx = context;
+  context->multicast_group = _group;
+  if (context->udp)
+  {
+    join_multicast_group();
+  }
 }
 
+IPAddress shRelayControl::getMulticastGroup() { return (context->multicast_group); }
+
 void shRelayControl::attachWebInterface(shWebServer *_server,
                                         FS *_file_system,
                                         const String &_relay_config_page,
                                         const String &_wifi_config_page)
 {
-  http_server = _server;
-  file_system = _file_system;
+  ctx = context;
+  context->http_server = _server;
+  context->file_system = _file_system;
+  // после перезагрузки версии состояния начинаются заново, поэтому клиенту вместе с версией
+  // передается идентификатор запуска
+  if (context->boot_id == 0)
+  {
+    context->boot_id = get_random_uint32() | 1;
+  }
 
-  if (load_config_file(mtRelay) && save_state_of_relay)
+  if (load_config_file(mtRelay) && context->save_state_of_relay)
   {
-    for (uint8_t i = 0; i < relayCount; i++)
+    // состояние реле из файла настроек дополняем изменениями из журнала и выставляем
+    // на выходах всех реле одной записью
+    bool compact = replay_relay_journal();
+    for (int16_t i = 0; i < context->relayCount; i++)
     {
-      if (relayArray[i].relayLastState)
+      if (context->relayArray[i].relayLastState)
       {
-        uint8_t lev = (relayArray[i].relayControlLevel) ? HIGH : LOW;
-        digitalWrite(relayArray[i].relayPin, lev);
+        context->relay_state[i >> 3] |= 1 << (i & 7);
+        context->output_mask[i >> 3] |= 1 << (i & 7);
       }
     }
+    commit_relay_outputs();
+    // файл настроек собирается из теневого регистра, поэтому журнал с поврежденным хвостом
+    // переносится в него только после восстановления состояния
+    if (compact)
+    {
+      save_config_file(mtRelay);
+    }
   }
 
-  relay_config_page = _relay_config_page;
-  wifi_config_page = _wifi_config_page;
+  context->relay_config_page = _relay_config_page;
+  context->wifi_config_page = _wifi_config_page;
 
-  if (relay_config_page.indexOf("/") != 0)
+  if (context->relay_config_page.indexOf("/") != 0)
   {
-    relay_config_page = "/" + relay_config_page;
+    context->relay_config_page = "/" + context->relay_config_page;
   }
-  if (wifi_config_page.length() > 0 && wifi_config_page.indexOf("/") != 0)
+  if (context->wifi_config_page.length() > 0 && context->wifi_config_page.indexOf("/") != 0)
   {
-    wifi_config_page = "/" + wifi_config_page;
+    context->wifi_config_page = "/" + context->wifi_config_page;
   }
 
-  if (http_server)
-  { // вызов стартовой страницы модуля реле
-    http_server->on("/", HTTP_GET, handleGetRelayIndexPage);
+  if (context->http_server)
+  {
+    collect_page_headers();
+    // вызов стартовой страницы модуля реле
+    add_web_handler("/", HTTP_GET, handleGetIndexPage);
     // вызов страницы настройки модуля реле
-    http_server->on(relay_config_page, HTTP_GET, handleGetRelayConfigPage);
+    add_web_handler(context->relay_config_page, HTTP_GET, handleGetConfigPage);
     // запрос текущих настроек
-    http_server->on(FPSTR(RELAY_GET_CONFIG), HTTP_GET, handleGetRelayConfig);
+    add_web_handler(FPSTR(RELAY_GET_CONFIG), HTTP_GET, handleGetRelayConfig);
+    add_web_handler(FPSTR(SR_GET_CONFIG), HTTP_GET, handleGetModuleConfig);
     // сохранение настроек
-    http_server->on(FPSTR(SR_SET_CONFIG), HTTP_POST, handleSetConfig);
+    add_web_handler(FPSTR(SR_SET_CONFIG), HTTP_POST, handleSetConfig);
     // переключение реле
-    http_server->on(FPSTR(RELAY_SWITCH), HTTP_POST, handleRelaySwitch);
+    add_web_handler(FPSTR(RELAY_SWITCH), HTTP_POST, handleRelaySwitch);
+    // установка состояния сразу нескольких реле
+    add_web_handler(FPSTR(RELAY_SET_STATES), HTTP_POST, handleRelaySetStates);
     // запрос текущего состояния всех реле
-    http_server->on(FPSTR(RELAY_GET_STATE), HTTP_GET, handleGetRelayState);
+    add_web_handler(FPSTR(RELAY_GET_STATE), HTTP_GET, handleGetRelayState);
+    // поток изменений состояния реле
+    add_web_handler(FPSTR(RELAY_EVENTS), HTTP_GET, handleRelayEvents);
   }
 }
 
+void shRelayControl::setUdpBudget(uint8_t _max_packets, uint16_t _max_time)
+{
+  udpPacketBudget = (_max_packets > 0) ? _max_packets : 1;
+  udpTimeBudget = _max_time;
+}
+
+uint8_t shRelayControl::getUdpPacketBudget() { return (udpPacketBudget); }
+
+uint16_t shRelayControl::getUdpTimeBudget() { return (udpTimeBudget); }
+
+void shRelayControl::setIdleDelay(uint8_t _delay) { idleDelay = _delay; }
+
+uint8_t shRelayControl::getIdleDelay() { return (idleDelay); }
+
 void shRelayControl::tick()
 {
-  for (uint8_t i = 0; i < relayCount; i++)
+  ctx = context;
+  bool busy = false;
+  for (int16_t i = 0; i < context->relayCount; i++)
   {
-    if (relayArray[i].relayButton != NULL &&
-        relayArray[i].relayButton->getButtonState() == BTN_DOWN)
+    if (context->relayArray[i].relayButton != NULL &&
+        context->relayArray[i].relayButton->getButtonState() == BTN_DOWN)
     {
-      bzr.btnBeep(); // одиночный пик на каждое нажатие любой кнопки
+      context->bzr.btnBeep(); // одиночный пик на каждое нажатие любой кнопки
       switch_local_relay(i);
+      busy = true;
     }
   }
 
-  int packet_size = udp->parsePacket();
-  if (packet_size > 0)
+  // после переподключения к WiFi модуль заново входит в группу multicast
+  check_multicast_group();
+
+  // пакеты сокета разбираются для всех модулей, использующих этот сокет
+  if (receive_udp_packets(context->udp, udpPacketBudget, udpTimeBudget))
+  {
+    busy = true;
+  }
+
+  // изменения состояния реле, накопленные за проход, рассылаются подписчикам разом
+  publish_relay_changes();
+
+  if (context->save_state_of_relay)
   {
-    receiveUdpPacket(packet_size);
+    flush_relay_state(false);
   }
 
-  http_server->handleClient();
-  delay(1);
+  context->http_server->handleClient();
+  idle_pause(busy, idleDelay);
 }
 
-void shRelayControl::respondToRelayCheck(int8_t index)
+void shRelayControl::respondToRelayCheck(int16_t index, bool _binary)
 {
-  if ((index >= 0) && (index < relayCount))
+  if ((index >= 0) && (index < ctx->relayCount))
   {
-    String s = get_json_string_to_send(relayArray[index].relayName,
-                                       relayArray[index].relayDescription,
-                                       sr_ok_str,
-                                       sr_respond_str);
-    SR_PRINT(relayArray[index].relayName);
+    SR_PRINT(ctx->relayArray[index].relayName);
     SR_PRINT(F(": request received, response - "));
-    SR_PRINTLN(sr_ok_str);
-    send_udp_packet(udp->remoteIP(), s.c_str(), s.length());
+    SR_PRINTLN(FPSTR(sr_ok_str));
+    send_response(ctx->udp->remoteIP(),
+                  ctx->relayArray[index].relayName,
+                  ctx->relayArray[index].relayDescription,
+                  rsOk,
+                  cmRespond,
+                  _binary,
+                  0);
   }
 }
 
-void set_state(int8_t relay_index, String comm)
+void set_state(int16_t relay_index, const srMessage &msg, bool _binary)
 {
-  if ((relay_index >= 0) && (relay_index < relayCount))
+  if ((relay_index >= 0) && (relay_index < ctx->relayCount))
   {
-    if (comm == sr_switch_str)
-    {
-      switch_local_relay(relay_index);
-    }
-    else if ((comm == sr_set_on_str) || (comm == sr_set_off_str))
-    {
-      set_local_relay_state(relay_index, (comm == sr_set_on_str));
-    }
-
-    String s = get_json_string_to_send(relayArray[relay_index].relayName,
-                                       relayArray[relay_index].relayDescription,
-                                       get_relay_state(relay_index),
-                                       comm);
-    send_udp_packet(udp->remoteIP(), s.c_str(), s.length());
+    // повторно полученная команда не выполняется, но ответ с текущим состоянием отправляется
+    bool state = (msg.duplicate) ? get_relay_state(relay_index)
+                                 : apply_local_command(relay_index, msg.command);
+    send_response(ctx->udp->remoteIP(),
+                  ctx->relayArray[relay_index].relayName,
+                  ctx->relayArray[relay_index].relayDescription,
+                  (state) ? rsOn : rsOff,
+                  msg.command,
+                  _binary,
+                  msg.seq);
   }
 }
 
-void shRelayControl::receiveUdpPacket(int _size)
+void shRelayControl::receiveUdpPacket(srMessage &msg)
 {
-  char _str[_size + 1] = {0};
+  msg.duplicate = is_duplicate_command(ctx->udp->remoteIP(), msg.session, msg.seq);
+  if (msg.duplicate)
+  {
+    SR_PRINT(F("Duplicate command skipped, seq: "));
+    SR_PRINTLN(msg.seq);
+  }
+
+  // отвечаем в бинарном виде, если отправитель его поддерживает
+  bool bin = msg.binary || msg.proto >= SR_PROTO_VERSION;
+
+  // отправитель команды управления становится подписчиком
+  if (msg.targetCount > 0 ||
+      (msg.command >= cmSwitch && msg.command <= cmSubscribe))
+  {
+    add_subscriber(ctx->udp->remoteIP(), bin);
+  }
 
-  udp->read(_str, _size);
-  udp->flush();
+  // групповая команда выполняется за один проход, ответ - один пакет
+  if (msg.targetCount > 0)
+  {
+    apply_multi_command(msg);
+    return;
+  }
 
-  String _resp = String(_str);
-  String comm = get_argument(_resp, sr_command_str);
-  String r_name = get_argument(_resp, sr_name_str);
-  if (comm == sr_respond_str)
+  switch (msg.command)
   {
-    if (r_name == sr_any_str)
+  case cmRespond:
+    if (msg.anyRelay)
     {
-      for (uint8_t i = 0; i < relayCount; i++)
+      for (int16_t i = 0; i < ctx->relayCount; i++)
       {
-        respondToRelayCheck(i);
+        respondToRelayCheck(i, bin);
       }
     }
     else
     {
-      respondToRelayCheck(getRelayIndexByName(r_name));
+      respondToRelayCheck(getRelayIndexByMessage(msg), bin);
     }
-  }
-  else if ((comm == sr_switch_str) ||
-           (comm == sr_set_on_str) ||
-           (comm == sr_set_off_str))
+    break;
+  case cmSubscribe:
   {
-    if (r_name == sr_any_str)
+    int16_t index = getRelayIndexByMessage(msg);
+    if (index >= 0)
+    {
+      send_response(ctx->udp->remoteIP(),
+                    ctx->relayArray[index].relayName,
+                    ctx->relayArray[index].relayDescription,
+                    rsOk,
+                    cmSubscribe,
+                    bin,
+                    msg.seq);
+    }
+  }
+  break;
+  case cmSwitch:
+  case cmSetOn:
+  case cmSetOff:
+    if (msg.anyRelay)
     {
-      for (uint8_t i = 0; i < relayCount; i++)
+      // все реле переключаются одновременно, одной записью в регистры GPIO
+      ctx->output_batch = true;
+      for (int16_t i = 0; i < ctx->relayCount; i++)
       {
-        set_state(i, comm);
+        set_state(i, msg, bin);
       }
+      ctx->output_batch = false;
+      commit_relay_outputs();
     }
     else
     {
-      set_state(getRelayIndexByName(_resp), comm);
+      set_state(getRelayIndexByMessage(msg), msg, bin);
     }
-  }
-  else
-  {
+    break;
+  default:
     // ответ о неизвестной команде
-    String s = get_json_string_to_send(WiFi.localIP().toString(),
-                                       module_description,
-                                       F("unknown command"),
-                                       comm);
-    send_udp_packet(udp->remoteIP(), s.c_str(), s.length());
+    send_response(ctx->udp->remoteIP(),
+                  WiFi.localIP().toString(),
+                  ctx->module_description,
+                  rsUnknown,
+                  cmUnknown,
+                  bin,
+                  msg.seq);
+    break;
   }
 }
 
-int8_t shRelayControl::getRelayIndexByName(String &_res)
+int16_t shRelayControl::getRelayIndexByMessage(const srMessage &msg)
+{
+  return ((msg.name.length() > 0) ? getRelayIndexByName(msg.name)
+                                  : getRelayIndexByHash(msg.nameHash));
+}
+
+int16_t shRelayControl::getRelayIndexByHash(uint32_t _hash)
+{
+  return (find_in_name_index(mtRelay, _hash, NULL));
+}
+
+int16_t shRelayControl::getRelayIndexByName(const String &_name)
 {
-  int8_t result = -1;
-  String name = get_argument(_res, sr_name_str);
-  if (name.length() > 0)
+  int16_t result = -1;
+  if (_name.length() > 0)
   {
-    for (int8_t i = 0; i < relayCount; i++)
-    {
-      if (relayArray[i].relayName == name)
-      {
-        result = i;
-        break;
-      }
-    }
+    result = find_in_name_index(mtRelay, get_name_hash(_name.c_str()), _name.c_str());
   }
 
   return result;
 }
 
-void shRelayControl::switchRelay(int8_t index)
+void shRelayControl::switchRelay(int16_t index)
 {
+  ctx = context;
   switch_local_relay(index);
 }
 
-void shRelayControl::switchRelay(String _name)
+void shRelayControl::switchRelay(const String &_name)
 {
+  ctx = context;
   switch_local_relay(getRelayIndexByName(_name));
 }
 
-void shRelayControl::setRelayState(int8_t index, bool state)
+void shRelayControl::setRelayState(int16_t index, bool state)
 {
+  ctx = context;
   set_local_relay_state(index, state);
 }
 
-void shRelayControl::setRelayState(String _name, bool state)
+void shRelayControl::setRelayState(const String &_name, bool state)
 {
+  ctx = context;
   set_local_relay_state(getRelayIndexByName(_name), state);
 }
 
-String shRelayControl::getRelayState(int8_t index)
+void shRelayControl::setSubscriptionLease(uint32_t _lease) { context->subscription_lease = _lease; }
+
+uint32_t shRelayControl::getSubscriptionLease() { return (context->subscription_lease); }
+
+uint32_t shRelayControl::getStateVersion() { return (context->state_version); }
+
+String shRelayControl::getRelayState(int16_t index)
 {
-  return (get_relay_state(index));
+  ctx = context;
+  return (get_state_str(get_relay_state(index)));
+}
+
+String shRelayControl::getRelayState(const String &_name)
+{
+  ctx = context;
+  return (get_state_str(get_relay_state(getRelayIndexByName(_name))));
+}
+
+RelayHandle shRelayControl::getRelayHandle(const char *_name)
+{
+  ctx = context;
+  RelayHandle result = -1;
+  if (_name && _name[0])
+  {
+    result = find_in_name_index(mtRelay, get_name_hash(_name), _name);
+  }
+
+  return (result);
 }
 
-String shRelayControl::getRelayState(String _name)
+SrRelayState shRelayControl::getState(RelayHandle _relay)
 {
-  return (get_relay_state(getRelayIndexByName(_name)));
+  ctx = context;
+  SrRelayState result = stUnknown;
+  if (_relay >= 0 && _relay < context->relayCount)
+  {
+    result = (get_relay_state(_relay)) ? stOn : stOff;
+  }
+
+  return (result);
 }
 
 void shRelayControl::setModuleDescription(String &_descr)
 {
-  module_description = _descr;
+  context->module_description = _descr;
 }
 
 String shRelayControl::getModuleDescription()
 {
-  return (module_description);
+  return (context->module_description);
 }
 
 void shRelayControl::setSaveStateOfRelay(bool _state)
 {
-  save_state_of_relay = _state;
+  context->save_state_of_relay = _state;
 }
 
 bool shRelayControl::getSaveStateOfRelay()
 {
-  return (save_state_of_relay);
+  return (context->save_state_of_relay);
+}
+
+void shRelayControl::setSaveStateDelay(uint32_t _delay)
+{
+  context->save_state_delay = _delay;
+}
+
+uint32_t shRelayControl::getSaveStateDelay()
+{
+  return (context->save_state_delay);
+}
+
+bool shRelayControl::flushRelayState()
+{
+  ctx = context;
+  return (flush_relay_state(true));
 }
 
-void shRelayControl::setRelayName(int8_t index, String &_name)
+void shRelayControl::setRelayName(int16_t index, String &_name)
 {
-  if ((index >= 0) && (index < relayCount))
+  ctx = context;
+  if ((index >= 0) && (index < context->relayCount))
   {
-    relayArray[index].relayName = _name;
+    context->relayArray[index].relayName = _name;
+    build_name_index(mtRelay);
   }
 }
-String shRelayControl::getRelayName(int8_t index)
+String shRelayControl::getRelayName(int16_t index)
 {
   String result = "";
-  if ((index >= 0) && (index < relayCount))
+  if ((index >= 0) && (index < context->relayCount))
   {
-    result = relayArray[index].relayName;
+    result = context->relayArray[index].relayName;
   }
 
   return (result);
 }
 
-void shRelayControl::setRelayDescription(int8_t index, String &_descr)
+void shRelayControl::setRelayDescription(int16_t index, String &_descr)
 {
-  if ((index >= 0) && (index < relayCount))
+  if ((index >= 0) && (index < context->relayCount))
   {
-    relayArray[index].relayDescription = _descr;
+    context->relayArray[index].relayDescription = _descr;
   }
 }
 
-String shRelayControl::getRelayDescription(int8_t index)
+String shRelayControl::getRelayDescription(int16_t index)
 {
   String result = "";
-  if ((index >= 0) && (index < relayCount))
+  if ((index >= 0) && (index < context->relayCount))
   {
-    result = relayArray[index].relayDescription;
+    result = context->relayArray[index].relayDescription;
   }
 
   return (result);
@@ -491,34 +1078,40 @@ String shRelayControl::getRelayDescription(int8_t index)
 
 void shRelayControl::setFileName(const String &_name)
 {
-  relayFileConfigName = _name;
+  context->relayFileConfigName = _name;
+  context->config_slot[mtRelay] = -1;
 }
 
 String shRelayControl::getFileName()
 {
-  return (relayFileConfigName);
+  return (context->relayFileConfigName);
 }
 
 bool shRelayControl::saveConfige()
 {
+  ctx = context;
   return (save_config_file(mtRelay));
 }
 
 bool shRelayControl::loadConfig()
 {
+  ctx = context;
   return (load_config_file(mtRelay));
 }
 
 // ==== shSwitchControl class ==========================
 
-shSwitchControl::shSwitchControl() {}
+shSwitchControl::shSwitchControl() { context = new srContext(mtSwitch); }
 
-void shSwitchControl::init(uint8_t _switch_count)
+void shSwitchControl::init(uint16_t _switch_count)
 {
-  switchArray = new shSwitchData[_switch_count];
-  if (switchArray)
+  if (_switch_count > SR_MAX_RELAY_COUNT)
+  {
+    _switch_count = SR_MAX_RELAY_COUNT;
+  }
+  if (context->switchArray.reserve(_switch_count))
   {
-    switchCount = _switch_count;
+    context->switchCount = _switch_count;
   }
 
   if (&Serial != NULL)
@@ -530,19 +1123,18 @@ void shSwitchControl::init(uint8_t _switch_count)
 bool shSwitchControl::addRelay(const String &relay_name,
                                srButton *relay_button)
 {
+  ctx = context;
   bool result = false;
-  if (switchCount > 0)
+  int16_t index = get_free_slot(mtSwitch);
+  if (index >= 0)
   {
-    for (uint8_t i = 0; i < switchCount; i++)
-    {
-      if (switchArray[i].relayName == "")
-      {
-        switchArray[i] = shSwitchData(relay_name,
-                                      relay_button);
-        result = true;
-        break;
-      }
-    }
+    context->switchArray[index] = shSwitchData(relay_name,
+                                               relay_button);
+    result = true;
+  }
+  if (result)
+  {
+    build_name_index(mtSwitch);
   }
   return (result);
 }
@@ -557,24 +1149,49 @@ bool shSwitchControl::getLogOnState() { return (logOnState); }
 
 void shSwitchControl::setErrorBuzzerState(bool _state, int8_t _pin)
 {
-  bzr.setState(_state, _pin);
+  context->bzr.setState(_state, _pin);
 }
 
-bool shSwitchControl::getErrorBuzzerState() { return (bzr.getState()); }
+bool shSwitchControl::getErrorBuzzerState() { return (context->bzr.getState()); }
 
 void shSwitchControl::setBtnBeepData(uint16_t _freq, uint32_t _dur)
 {
-  bzr.setBtnBeepData(_freq, _dur);
+  context->bzr.setBtnBeepData(_freq, _dur);
 }
 
 void shSwitchControl::setCheckTimer(uint32_t _timer) { checkInterval = _timer; }
 
 uint32_t shSwitchControl::getCheckTimer() { return (checkInterval); }
 
+void shSwitchControl::setRelayTtl(uint32_t _ttl) { context->relay_ttl = _ttl; }
+
+uint32_t shSwitchControl::getRelayTtl() { return (context->relay_ttl); }
+
+void shSwitchControl::setMulticastGroup(const IPAddress &_group)
+{
+  ctx = context;
+  // выключатель в группу не входит - он только отправляет в нее запросы, ответы приходят на его адрес
+  context->multicast_group = _group;
+  context->multicast_joined = is_multicast_address(context->multicast_group);
+}
+
+IPAddress shSwitchControl::getMulticastGroup() { return (context->multicast_group); }
+
 void shSwitchControl::startDevice(WiFiUDP *_udp, uint16_t _local_port)
 {
-  udp = _udp;
-  localPort = _local_port;
+  ctx = context;
+  context->udp = _udp;
+  context->localPort = _local_port;
+  context->onMessage = [this](srMessage &msg)
+  { receiveUdpPacket(msg); };
+  add_udp_module(context);
+  // новый сеанс и случайный начальный номер команды - реле не примет команды после
+  // перезагрузки выключателя за повторы уже выполненных
+  if (context->session == 0)
+  {
+    context->session = get_random_uint32() | 1;
+    context->command_seq = get_random_uint32();
+  }
   // выполнить первичный поиск привязанных реле
   find_remote_relays();
 }
@@ -584,166 +1201,237 @@ void shSwitchControl::attachWebInterface(shWebServer *_server,
                                          const String &_relay_config_page,
                                          const String &_wifi_config_page)
 {
-  http_server = _server;
-  file_system = _file_system;
+  ctx = context;
+  context->http_server = _server;
+  context->file_system = _file_system;
 
-  relay_config_page = _relay_config_page;
-  wifi_config_page = _wifi_config_page;
+  context->relay_config_page = _relay_config_page;
+  context->wifi_config_page = _wifi_config_page;
 
-  if (relay_config_page.indexOf("/") != 0)
+  if (context->relay_config_page.indexOf("/") != 0)
   {
-    relay_config_page = "/" + relay_config_page;
+    context->relay_config_page = "/" + context->relay_config_page;
   }
-  if (wifi_config_page.length() > 0 && wifi_config_page.indexOf("/") != 0)
+  if (context->wifi_config_page.length() > 0 && context->wifi_config_page.indexOf("/") != 0)
   {
-    wifi_config_page = "/" + wifi_config_page;
+    context->wifi_config_page = "/" + context->wifi_config_page;
   }
 
   load_config_file(mtSwitch);
 
-  if (http_server)
-  { // вызов стартовой страницы модуля выключателя
-    http_server->on("/", HTTP_GET, handleGetSwitchIndexPage);
+  if (context->http_server)
+  {
+    collect_page_headers();
+    // вызов стартовой страницы модуля выключателя
+    add_web_handler("/", HTTP_GET, handleGetIndexPage);
     // вызов страницы настройки модуля выключателей
-    http_server->on(_relay_config_page, HTTP_GET, handleGetSwitchConfigPage);
+    add_web_handler(_relay_config_page, HTTP_GET, handleGetConfigPage);
     // запрос текущих настроек
-    http_server->on(FPSTR(SWITCH_GET_CONFIG), HTTP_GET, handleGetSwitchConfig);
+    add_web_handler(FPSTR(SWITCH_GET_CONFIG), HTTP_GET, handleGetSwitchConfig);
+    add_web_handler(FPSTR(SR_GET_CONFIG), HTTP_GET, handleGetModuleConfig);
     // сохранение настроек
-    http_server->on(FPSTR(SR_SET_CONFIG), HTTP_POST, handleSetConfig);
+    add_web_handler(FPSTR(SR_SET_CONFIG), HTTP_POST, handleSetConfig);
     // переключение реле
-    http_server->on(FPSTR(REMOTE_RELAY_SWITCH), HTTP_POST, handleRemoteRelaySwitch);
+    add_web_handler(FPSTR(REMOTE_RELAY_SWITCH), HTTP_POST, handleRemoteRelaySwitch);
+    // установка состояния сразу нескольких удаленных реле
+    add_web_handler(FPSTR(REMOTE_SET_STATES), HTTP_POST, handleRemoteSetStates);
   }
 }
 
+void shSwitchControl::setUdpBudget(uint8_t _max_packets, uint16_t _max_time)
+{
+  udpPacketBudget = (_max_packets > 0) ? _max_packets : 1;
+  udpTimeBudget = _max_time;
+}
+
+uint8_t shSwitchControl::getUdpPacketBudget() { return (udpPacketBudget); }
+
+uint16_t shSwitchControl::getUdpTimeBudget() { return (udpTimeBudget); }
+
+void shSwitchControl::setIdleDelay(uint8_t _delay) { idleDelay = _delay; }
+
+uint8_t shSwitchControl::getIdleDelay() { return (idleDelay); }
+
 void shSwitchControl::tick()
 {
-  for (uint8_t i = 0; i < switchCount; i++)
+  ctx = context;
+  bool busy = false;
+  for (int16_t i = 0; i < context->switchCount; i++)
   {
-    if (switchArray[i].relayButton != NULL &&
-        switchArray[i].relayButton->getButtonState() == BTN_DOWN)
+    if (context->switchArray[i].relayButton != NULL &&
+        context->switchArray[i].relayButton->getButtonState() == BTN_DOWN)
     {
-      bzr.btnBeep(); // одиночный пик на каждое нажатие любой кнопки
+      context->bzr.btnBeep(); // одиночный пик на каждое нажатие любой кнопки
       switch_remote_relay(i);
+      busy = true;
     }
   }
 
+  // повтор команд, оставшихся без подтверждения
+  if (retry_pending_commands())
+  {
+    busy = true;
+  }
+
   // проверка доступности реле через заданный интервал
   if (millis() - checkTimer >= checkInterval)
   {
     checkTimer = millis();
-    find_remote_relays();
+    check_remote_relays(checkInterval);
   }
 
-  int packet_size = udp->parsePacket();
-  if (packet_size > 0)
+  // пакеты сокета разбираются для всех модулей, использующих этот сокет
+  if (receive_udp_packets(context->udp, udpPacketBudget, udpTimeBudget))
   {
-    receiveUdpPacket(packet_size);
+    busy = true;
   }
 
-  http_server->handleClient();
-  delay(1);
+  context->http_server->handleClient();
+  idle_pause(busy, idleDelay);
 }
 
-void shSwitchControl::receiveUdpPacket(int _size)
+void shSwitchControl::receiveUdpPacket(srMessage &msg)
 {
-  char _str[_size + 1] = {0};
-  udp->read(_str, _size);
-  udp->flush();
-
-  String _resp = String(_str);
+  // сюда попадают только ответы реле; пакеты, отправленные на широковещательный или групповой адрес, пропускаем
 #if defined(ARDUINO_ARCH_ESP8266)
-  if ((udp->destinationIP() != get_broadcast_address()))
+  if ((ctx->udp->destinationIP() != get_broadcast_address()) &&
+      (ctx->udp->destinationIP() != ctx->multicast_group))
   {
 #endif
-    int8_t relay_index = getRelayIndexByName(_resp);
-    if (relay_index >= 0)
+    // ответ на групповую команду - состояние каждого реле из списка
+    for (uint8_t i = 0; i < msg.targetCount; i++)
     {
-      switchArray[relay_index].relayFound = true;
-      String arg_for = get_argument(_resp, sr_for_str);
-      if (arg_for == sr_respond_str)
+      const uint8_t *target = msg.targets + i * (SR_BIN_TARGET_SIZE + 2) + 2;
+      int16_t index = getRelayIndexByHash(get_bin_uint32(target));
+      if (index >= 0)
       {
-        switchArray[relay_index].relayDescription = get_argument(_resp, sr_descr_str);
-        switchArray[relay_index].relayAddress = udp->remoteIP();
-        SR_PRINT(switchArray[relay_index].relayName);
-        SR_PRINT(F(" found, IP address: "));
-        SR_PRINTLN(switchArray[relay_index].relayAddress);
+        mark_relay_seen(index);
+        confirm_command(index, msg.seq);
+        set_remote_state(index, target[4]);
+        SR_PRINT(ctx->switchArray[index].relayName);
+        SR_PRINT((msg.forComm == cmNotify) ? F(" state - ") : F(" response - "));
+        SR_PRINTLN(get_response_str(target[4]));
       }
-      else if (arg_for == sr_switch_str ||
-               arg_for == sr_set_on_str ||
-               arg_for == sr_set_off_str)
+    }
+    if (msg.targetCount > 0)
+    {
+      return;
+    }
+
+    if (msg.forComm == cmRespond)
+    {
+      receive_discovery_reply();
+    }
+
+    int16_t relay_index = getRelayIndexByMessage(msg);
+    if (relay_index >= 0)
+    {
+      mark_relay_seen(relay_index);
+      // бинарный ответ означает, что реле понимает бинарный протокол
+      ctx->switchArray[relay_index].relayProto = (msg.binary) ? SR_PROTO_VERSION : msg.proto;
+      switch (msg.forComm)
       {
-        SR_PRINT(switchArray[relay_index].relayName);
-        SR_PRINT(F(" response - "));
-        SR_PRINTLN(get_argument(_resp, sr_response_str));
+      case cmRespond:
+        ctx->switchArray[relay_index].relayDescription = msg.descr;
+        ctx->switchArray[relay_index].relayAddress = ctx->udp->remoteIP();
+        SR_PRINT(ctx->switchArray[relay_index].relayName);
+        SR_PRINT(F(" found, IP address: "));
+        SR_PRINTLN(ctx->switchArray[relay_index].relayAddress);
+        // сразу подписываемся на уведомления, не дожидаясь очередной проверки
+        if (ctx->subscribe_state && ctx->switchArray[relay_index].relayProto >= SR_PROTO_VERSION)
+        {
+          send_subscribe(relay_index);
+        }
+        break;
+      case cmSwitch:
+      case cmSetOn:
+      case cmSetOff:
+        receive_relay_response(relay_index, msg.response, msg.seq);
+        break;
+      case cmNotify:
+        set_remote_state(relay_index, msg.response);
+        SR_PRINT(ctx->switchArray[relay_index].relayName);
+        SR_PRINT(F(" state - "));
+        SR_PRINTLN(get_response_str(msg.response));
+        break;
       }
     }
     else
     {
       // ответ на случай, если имя ответившего реле модулю неизвестно
       SR_PRINT(F("Module "));
-      SR_PRINT(get_argument(_resp, sr_name_str));
+      SR_PRINT(msg.name);
       SR_PRINT(F(", "));
-      SR_PRINT(get_argument(_resp, sr_descr_str));
+      SR_PRINT(msg.descr);
       SR_PRINT(F(" response - "));
-      SR_PRINTLN(get_argument(_resp, sr_response_str));
+      SR_PRINTLN(get_response_str(msg.response));
     }
 #if defined(ARDUINO_ARCH_ESP8266)
   }
   else
   {
-    SR_PRINT(F("Skiped broadcast packet from "));
-    SR_PRINTLN(udp->remoteIP());
+    SR_PRINT(F("Skiped broadcast or multicast packet from "));
+    SR_PRINTLN(ctx->udp->remoteIP());
   }
 #endif
 }
 
-int8_t shSwitchControl::getRelayIndexByName(String &_res)
+int16_t shSwitchControl::getRelayIndexByMessage(const srMessage &msg)
+{
+  return ((msg.name.length() > 0) ? getRelayIndexByName(msg.name)
+                                  : getRelayIndexByHash(msg.nameHash));
+}
+
+int16_t shSwitchControl::getRelayIndexByHash(uint32_t _hash)
+{
+  return (find_in_name_index(mtSwitch, _hash, NULL));
+}
+
+int16_t shSwitchControl::getRelayIndexByName(const String &_name)
 {
-  int8_t result = -1;
-  String name = get_argument(_res, sr_name_str);
-  if (name.length() > 0)
+  int16_t result = -1;
+  if (_name.length() > 0)
   {
-    for (int8_t i = 0; i < switchCount; i++)
-    {
-      if (switchArray[i].relayName == name)
-      {
-        result = i;
-        break;
-      }
-    }
+    result = find_in_name_index(mtSwitch, get_name_hash(_name.c_str()), _name.c_str());
   }
 
   return result;
 }
 
-void shSwitchControl::switchRelay(int8_t index)
+void shSwitchControl::switchRelay(int16_t index)
 {
+  ctx = context;
   switch_remote_relay(index);
 }
 
-void shSwitchControl::switchRelay(String _name)
+void shSwitchControl::switchRelay(const String &_name)
 {
+  ctx = context;
   switch_remote_relay(getRelayIndexByName(_name));
 }
 
-void shSwitchControl::setRelayState(int8_t index, bool state)
+void shSwitchControl::setRelayState(int16_t index, bool state)
 {
+  ctx = context;
   set_remote_relay_state(index, state);
 }
 
-void shSwitchControl::setRelayState(String _name, bool state)
+void shSwitchControl::setRelayState(const String &_name, bool state)
 {
+  ctx = context;
   set_remote_relay_state(getRelayIndexByName(_name), state);
 }
 
 void shSwitchControl::setStateForAll(bool state, bool _self)
 {
+  ctx = context;
   if (_self)
   {
-    for (uint8_t i = 0; i < switchCount; i++)
-    {
-      set_remote_relay_state(i, state);
-    }
+    uint8_t mask[SR_MASK_SIZE];
+    uint8_t states[SR_MASK_SIZE];
+    memset(mask, 0xFF, sizeof(mask));
+    memset(states, (state) ? 0xFF : 0x00, sizeof(states));
+    send_multi_command(mask, states);
   }
   else
   {
@@ -753,54 +1441,123 @@ void shSwitchControl::setStateForAll(bool state, bool _self)
 
 void shSwitchControl::findRelays()
 {
+  ctx = context;
   find_remote_relays();
 }
 
-void shSwitchControl::setModuleDescription(const String &_descr)
+void shSwitchControl::setCommandRetryData(uint8_t _retries, uint16_t _timeout)
 {
-  module_description = _descr;
+  // интервал ожидания удваивается с каждым повтором, поэтому повторов не больше 8
+  context->command_retries = (_retries > 8) ? 8 : _retries;
+  context->command_timeout = _timeout;
 }
 
-String shSwitchControl::getModuleDescription()
+uint8_t shSwitchControl::getCommandRetries() { return (context->command_retries); }
+
+uint16_t shSwitchControl::getCommandTimeout() { return (context->command_timeout); }
+
+uint16_t shSwitchControl::getCommandSuccessCount(int16_t index)
+{
+  return ((index >= 0 && index < context->switchCount) ? context->switchArray[index].commandSuccess : 0);
+}
+
+uint16_t shSwitchControl::getCommandFailedCount(int16_t index)
+{
+  return ((index >= 0 && index < context->switchCount) ? context->switchArray[index].commandFailed : 0);
+}
+
+void shSwitchControl::setSubscribeState(bool _state) { context->subscribe_state = _state; }
+
+bool shSwitchControl::getSubscribeState() { return (context->subscribe_state); }
+
+String shSwitchControl::getRelayState(int16_t index)
 {
-  return (module_description);
+  SrRelayState state = getState(index);
+
+  return ((state == stUnknown) ? String("") : String(get_state_str(state == stOn)));
 }
 
-void shSwitchControl::setRelayName(int8_t index, String _name)
+RelayHandle shSwitchControl::getRelayHandle(const char *_name)
 {
-  if ((index >= 0) && (index < switchCount))
+  ctx = context;
+  RelayHandle result = -1;
+  if (_name && _name[0])
   {
-    switchArray[index].relayName = _name;
+    result = find_in_name_index(mtSwitch, get_name_hash(_name), _name);
   }
+
+  return (result);
 }
-String shSwitchControl::getRelayName(int8_t index)
+
+SrRelayState shSwitchControl::getState(RelayHandle _relay)
 {
-  String result = "";
-  if ((index >= 0) && (index < switchCount))
+  ctx = context;
+  SrRelayState result = stUnknown;
+  // состояние реле этой же прошивки известно всегда, даже если команд ему еще не отправлялось
+  if (find_local_relay(_relay))
+  {
+    shSwitchData &data = context->switchArray[_relay];
+    srContext *mdl = udp_modules[data.localModule];
+    data.relayState = (mdl->relay_state[data.localIndex >> 3] >> (data.localIndex & 7)) & 0x01;
+  }
+  if (_relay >= 0 && _relay < context->switchCount && context->switchArray[_relay].relayState >= 0)
   {
-    result = switchArray[index].relayName;
+    result = (context->switchArray[_relay].relayState) ? stOn : stOff;
   }
 
   return (result);
 }
 
-void shSwitchControl::setFileName(const String &_name)
+void shSwitchControl::setModuleDescription(const String &_descr)
 {
-  switchFileConfigName = _name;
+  context->module_description = _descr;
 }
 
-String shSwitchControl::getFileName()
+String shSwitchControl::getModuleDescription()
 {
-  return (switchFileConfigName);
+  return (context->module_description);
 }
 
-bool shSwitchControl::saveConfige()
+void shSwitchControl::setRelayName(int16_t index, String _name)
 {
+  ctx = context;
+  if ((index >= 0) && (index < context->switchCount))
+  {
+    context->switchArray[index].relayName = _name;
+    build_name_index(mtSwitch);
+  }
+}
+String shSwitchControl::getRelayName(int16_t index)
+{
+  String result = "";
+  if ((index >= 0) && (index < context->switchCount))
+  {
+    result = context->switchArray[index].relayName;
+  }
+
+  return (result);
+}
+
+void shSwitchControl::setFileName(const String &_name)
+{
+  context->switchFileConfigName = _name;
+  context->config_slot[mtSwitch] = -1;
+}
+
+String shSwitchControl::getFileName()
+{
+  return (context->switchFileConfigName);
+}
+
+bool shSwitchControl::saveConfige()
+{
+  ctx = context;
   return (save_config_file(mtSwitch));
 }
 
 bool shSwitchControl::loadConfig()
 {
+  ctx = context;
   return (load_config_file(mtSwitch));
 }
 
@@ -826,473 +1583,2569 @@ static IPAddress get_broadcast_address()
   return (result);
 }
 
-static bool get_value_of_argument(String &_res, const String &_arg, String &_str)
+static IPAddress get_discovery_address()
 {
-  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+  // multicast получают только модули, вошедшие в группу; если группа не задана, войти в нее
+  // не удалось или на запросы в группу никто не отвечает, используется широковещательный адрес
+  bool group = ctx->multicast_joined &&
+               ctx->multicast_misses < SR_MULTICAST_MISSES &&
+               WiFi.isConnected();
+  return ((group) ? ctx->multicast_group : get_broadcast_address());
+}
 
-  DeserializationError error = deserializeJson(doc, _res);
-  bool result = !error;
-  if (result)
+static bool is_multicast_address(const IPAddress &address)
+{
+  // 224.0.0.0 - 239.255.255.255
+  return ((address[0] & 0xF0) == 0xE0);
+}
+
+static bool join_multicast_group()
+{
+  ctx->multicast_joined = false;
+  if (!is_multicast_address(ctx->multicast_group))
   {
-    result = doc[_arg].as<String>() != "null";
+    return (false);
   }
-  else
+  ctx->multicast_ip = (WiFi.isConnected()) ? WiFi.localIP() : IPAddress(0, 0, 0, 0);
+
+  // сокет заново открывается на том же порту, поэтому пакеты на адрес модуля по-прежнему принимаются
+#if defined(ARDUINO_ARCH_ESP8266)
+  ctx->multicast_joined = ctx->udp->beginMulticast(WiFi.localIP(), ctx->multicast_group, ctx->localPort);
+#else
+  ctx->multicast_joined = ctx->udp->beginMulticast(ctx->multicast_group, ctx->localPort);
+#endif
+  SR_PRINT(F("Join multicast group "));
+  SR_PRINT(ctx->multicast_group);
+  SR_PRINTLN((ctx->multicast_joined) ? F(": OK") : F(": failed, broadcast is used"));
+  if (!ctx->multicast_joined)
   {
-    SR_PRINTLN(F("invalid response data"));
-    SR_PRINTLN(error.f_str());
+    ctx->udp->begin(ctx->localPort);
   }
 
-  if (result)
+  return (ctx->multicast_joined);
+}
+
+static void check_multicast_group()
+{
+  // членство в группе теряется при разрыве связи с точкой доступа, а вход в группу до
+  // подключения к WiFi не действует, поэтому при каждом новом подключении (или смене адреса
+  // модуля) вход в группу повторяется
+  if (!is_multicast_address(ctx->multicast_group))
   {
-    _str = doc[_arg].as<String>();
+    return;
   }
 
-  return result;
+  if (!WiFi.isConnected())
+  {
+    ctx->multicast_ip = IPAddress(0, 0, 0, 0);
+  }
+  else if (WiFi.localIP() != ctx->multicast_ip)
+  {
+    join_multicast_group();
+  }
 }
 
-static bool send_udp_packet(const IPAddress &address, const char *buf, size_t bufSize)
+static void check_multicast_replies()
 {
-  bool result = udp->beginPacket(address, localPort);
-
-  if (result)
+  // модули реле могут не получать пакеты группы, например, если точка доступа их не пропускает;
+  // если на запрос поиска всех реле в группу несколько проверок подряд не ответил ни один модуль,
+  // выключатель переходит на широковещательный адрес, а через SR_MULTICAST_RETRY снова пробует
+  // группу; именные запросы не учитываются - ненайденное реле может быть просто выключено
+  if (ctx->multicast_probe)
   {
-    uint8_t *_buf = new uint8_t[bufSize];
-    result = (_buf != NULL);
-    if (result)
+    ctx->multicast_probe = false;
+    if (++ctx->multicast_misses == SR_MULTICAST_MISSES)
     {
-      memcpy(_buf, buf, bufSize);
-      udp->write(_buf, bufSize);
-      delete[] _buf;
-
-      result = udp->endPacket() == 1;
+      ctx->multicast_fallback_timer = millis();
+      SR_PRINTLN(F("No response to requests to multicast group, broadcast is used"));
     }
   }
+  else if (ctx->broadcast_probe)
+  {
+    // на широковещательный запрос тоже никто не ответил - значит, дело не в группе
+    ctx->broadcast_probe = false;
+    ctx->multicast_misses = 0;
+    SR_PRINTLN(F("No response to broadcast requests either, multicast group is used"));
+  }
+  else if (ctx->multicast_misses >= SR_MULTICAST_MISSES &&
+           millis() - ctx->multicast_fallback_timer >= SR_MULTICAST_RETRY)
+  {
+    ctx->multicast_misses = 0;
+  }
+}
 
-  if (!result)
+static void idle_pause(bool _busy, uint8_t _delay)
+{
+  // если работа была, только отдаем управление системе, иначе можно поспать
+  if (_busy || _delay == 0)
   {
-    SR_PRINT(F("Error sending UDP packet for IP "));
-    SR_PRINT(address);
-    SR_PRINT(F(", remote port: "));
-    SR_PRINTLN((String)localPort);
+    yield();
+  }
+  else
+  {
+    delay(_delay);
   }
+}
 
-  return (result);
+static void add_udp_module(srContext *_ctx)
+{
+  int8_t n = -1;
+  for (uint8_t i = 0; i < SR_MAX_UDP_MODULES; i++)
+  {
+    if (udp_modules[i] == _ctx)
+    {
+      return;
+    }
+    if (n < 0 && udp_modules[i] == NULL)
+    {
+      n = i;
+    }
+  }
+
+  if (n >= 0)
+  {
+    udp_modules[n] = _ctx;
+  }
+  else
+  {
+    SR_PRINTLN(F("Failed to start module, too many modules in one firmware"));
+  }
 }
 
-static String get_argument(String &_res, const String &_arg)
+static bool receive_udp_packets(WiFiUDP *_udp, uint8_t _max_packets, uint16_t _max_time)
 {
-  String result = "";
-  get_value_of_argument(_res, _arg, result);
-  return result;
+  bool result = false;
+  srContext *current = ctx;
+  // выбираем все накопившиеся пакеты, но не больше заданного бюджета
+  uint32_t start = millis();
+  for (uint8_t i = 0; i < _max_packets; i++)
+  {
+    int packet_size = _udp->parsePacket();
+    if (packet_size <= 0)
+    {
+      break;
+    }
+    result = true;
+
+    char _str[packet_size + 1] = {0};
+    _udp->read(_str, packet_size);
+    _udp->flush();
+
+    // пакет разбирается один раз; ответы реле (в т.ч. уведомления) передаются выключателям,
+    // остальные пакеты - модулям реле
+    srMessage msg;
+    if (decode_udp_packet(_str, packet_size, msg))
+    {
+      for (uint8_t m = 0; m < SR_MAX_UDP_MODULES; m++)
+      {
+        if (udp_modules[m] != NULL &&
+            udp_modules[m]->udp == _udp &&
+            (udp_modules[m]->type == mtSwitch) == msg.reply)
+        {
+          ctx = udp_modules[m];
+          msg.duplicate = false;
+          ctx->onMessage(msg);
+        }
+      }
+      ctx = current;
+    }
+
+    if (millis() - start >= _max_time)
+    {
+      break;
+    }
+  }
+
+  return (result);
 }
 
-static String get_json_string_to_send(const String &_name,
-                                      const String &_descr,
-                                      const String &_comm,
-                                      const String &_for)
+static bool decode_udp_packet(char *buf, size_t bufSize, srMessage &msg)
 {
+  if (bufSize > 0 && (uint8_t)buf[0] == SR_BIN_MAGIC)
+  {
+    return (decode_bin_packet((const uint8_t *)buf, bufSize, msg));
+  }
+
+  // разбираем пакет один раз, оставляя в документе только нужные поля
+  StaticJsonDocument<192> filter;
+  filter[FPSTR(sr_name_str)] = true;
+  filter[FPSTR(sr_command_str)] = true;
+  filter[FPSTR(sr_for_str)] = true;
+  filter[FPSTR(sr_response_str)] = true;
+  filter[FPSTR(sr_descr_str)] = true;
+  filter[FPSTR(sr_proto_str)] = true;
+
   StaticJsonDocument<RELAY_DATA_SIZE> doc;
 
-  doc[sr_name_str] = _name;
-  doc[sr_descr_str] = _descr;
-  doc[sr_for_str] = _for;
-  doc[sr_response_str] = _comm;
+  DeserializationError error = deserializeJson(doc, buf, bufSize,
+                                               DeserializationOption::Filter(filter));
+  if (error)
+  {
+    SR_PRINTLN(F("invalid response data"));
+    SR_PRINTLN(error.f_str());
+    return (false);
+  }
 
-  String _res = "";
-  serializeJson(doc, _res);
+  // строковые значения команд и ответов сразу переводим в коды
+  msg.name = doc[FPSTR(sr_name_str)] | "";
+  msg.descr = doc[FPSTR(sr_descr_str)] | "";
+  msg.command = get_command_code(doc[FPSTR(sr_command_str)] | "");
+  msg.forComm = get_command_code(doc[FPSTR(sr_for_str)] | "");
+  msg.response = get_response_code(doc[FPSTR(sr_response_str)] | "");
+  msg.anyRelay = strcmp_P(msg.name.c_str(), sr_any_str) == 0;
+  msg.proto = doc[FPSTR(sr_proto_str)] | 0;
+  msg.reply = doc.containsKey(FPSTR(sr_response_str));
 
-  return (_res);
+  return (true);
 }
 
-static String get_json_string_to_send(const String &_name, const String &_comm)
+static bool decode_bin_packet(const uint8_t *buf, size_t bufSize, srMessage &msg)
 {
-  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+  if (bufSize < SR_BIN_HEADER_SIZE || buf[1] != SR_PROTO_VERSION)
+  {
+    SR_PRINTLN(F("invalid binary packet"));
+    return (false);
+  }
+
+  msg.binary = true;
+  msg.proto = buf[1];
+  uint8_t flags = buf[3];
+  msg.seq = (uint16_t)buf[4] | ((uint16_t)buf[5] << 8);
+  msg.nameHash = get_bin_uint32(buf + 6);
+  msg.anyRelay = flags & bfAnyRelay;
+  msg.reply = flags & bfReply;
+  uint8_t comm = (buf[2] <= cmNotify) ? buf[2] : cmUnknown;
+  if (flags & bfReply)
+  {
+    msg.forComm = comm;
+  }
+  else
+  {
+    msg.command = comm;
+  }
+
+  // необязательные поля
+  size_t pos = SR_BIN_HEADER_SIZE;
+  while (pos + 2 <= bufSize)
+  {
+    uint8_t field = buf[pos];
+    uint8_t len = buf[pos + 1];
+    pos += 2;
+    if (pos + len > bufSize)
+    {
+      break;
+    }
+
+    switch (field)
+    {
+    case pfName:
+    case pfDescr:
+    {
+      String &str = (field == pfName) ? msg.name : msg.descr;
+      str = "";
+      str.concat((const char *)buf + pos, len);
+    }
+    break;
+    case pfResp:
+      if (len > 0)
+      {
+        msg.response = (buf[pos] <= rsUnknown) ? buf[pos] : rsUnknown;
+      }
+      break;
+    case pfSession:
+      if (len == 4)
+      {
+        msg.session = get_bin_uint32(buf + pos);
+      }
+      break;
+    case pfTarget:
+      // цели групповой команды идут подряд, запоминаем только начало первой
+      if ((flags & bfMulti) &&
+          len == SR_BIN_TARGET_SIZE &&
+          (msg.targetCount == 0 ||
+           buf + pos - 2 == msg.targets + msg.targetCount * (SR_BIN_TARGET_SIZE + 2)))
+      {
+        if (msg.targetCount == 0)
+        {
+          msg.targets = buf + pos - 2;
+        }
+        msg.targetCount++;
+      }
+      break;
+    }
+    pos += len;
+  }
 
-  doc[sr_name_str] = _name;
-  doc[sr_command_str] = _comm;
+  return (true);
+}
 
-  String _res = "";
-  serializeJson(doc, _res);
+static uint32_t get_bin_uint32(const uint8_t *buf)
+{
+  return ((uint32_t)buf[0] |
+          ((uint32_t)buf[1] << 8) |
+          ((uint32_t)buf[2] << 16) |
+          ((uint32_t)buf[3] << 24));
+}
 
-  return (_res);
+static void set_bin_uint32(uint8_t *buf, uint32_t _value)
+{
+  buf[0] = _value & 0xFF;
+  buf[1] = (_value >> 8) & 0xFF;
+  buf[2] = (_value >> 16) & 0xFF;
+  buf[3] = (_value >> 24) & 0xFF;
 }
 
-static void switch_local_relay(int8_t index)
+static uint32_t get_name_hash(const char *_name)
 {
-  if ((index >= 0) && (index < relayCount))
+  // FNV-1a
+  uint32_t result = 2166136261UL;
+  while (*_name)
   {
-    set_local_relay_state(index, !(get_relay_state(index) == sr_on_str));
+    result ^= (uint8_t)*_name++;
+    result *= 16777619UL;
   }
+
+  return (result);
 }
 
-static void set_local_relay_state(int8_t index, bool state)
+static void build_name_index(ModuleType _mdt)
 {
-  if ((index >= 0) && (index < relayCount))
+  srNameIndex &ind = (_mdt == mtRelay) ? ctx->relayNameIndex : ctx->switchNameIndex;
+  int16_t count = (_mdt == mtRelay) ? ctx->relayCount : ctx->switchCount;
+
+  // размер индекса - степень двойки, не менее чем вдвое больше количества реле
+  uint16_t size = 4;
+  while (size < (uint16_t)count * 2)
+  {
+    size <<= 1;
+  }
+
+  if (ind.size != size)
+  {
+    delete[] ind.slots;
+    ind.slots = new int16_t[size];
+    ind.size = (ind.slots) ? size : 0;
+  }
+
+  for (uint16_t i = 0; i < ind.size; i++)
   {
-    if (!relayArray[index].relayControlLevel)
+    ind.slots[i] = -1;
+  }
+
+  for (int16_t i = 0; i < count; i++)
+  {
+    String &name = (_mdt == mtRelay) ? ctx->relayArray[i].relayName
+                                     : ctx->switchArray[i].relayName;
+    uint32_t hash = (name.length() > 0) ? get_name_hash(name.c_str()) : 0;
+    if (_mdt == mtRelay)
+    {
+      ctx->relayArray[i].relayNameHash = hash;
+    }
+    else
     {
-      state = !state;
+      ctx->switchArray[i].relayNameHash = hash;
     }
-    digitalWrite(relayArray[index].relayPin, state);
-    relayArray[index].relayLastState = get_relay_state(index) == sr_on_str;
-    if (save_state_of_relay)
+
+    if (name.length() > 0 && ind.size > 0)
     {
-      save_config_file(mtRelay);
+      uint16_t pos = hash & (ind.size - 1);
+      while (ind.slots[pos] >= 0)
+      {
+        pos = (pos + 1) & (ind.size - 1);
+      }
+      ind.slots[pos] = i;
     }
+  }
+}
 
-    SR_PRINT(relayArray[index].relayName);
-    SR_PRINT(F(": state - "));
-    SR_PRINTLN(get_relay_state(index));
+static int16_t get_free_slot(ModuleType _mdt)
+{
+  int16_t &count = (_mdt == mtRelay) ? ctx->relayCount : ctx->switchCount;
+  for (int16_t i = 0; i < count; i++)
+  {
+    const String &name = (_mdt == mtRelay) ? ctx->relayArray[i].relayName
+                                           : ctx->switchArray[i].relayName;
+    if (name == "")
+    {
+      return (i);
+    }
   }
+
+  // свободных записей нет - увеличиваем таблицу; уже добавленные реле при этом не перемещаются
+  bool grown = (count < SR_MAX_RELAY_COUNT) &&
+               ((_mdt == mtRelay) ? ctx->relayArray.reserve(count + 1)
+                                  : ctx->switchArray.reserve(count + 1));
+
+  return ((grown) ? count++ : -1);
 }
 
-static String get_relay_state(int8_t index)
+static int16_t find_in_name_index(ModuleType _mdt, uint32_t _hash, const char *_name)
 {
-  String result = sr_off_str;
+  srNameIndex &ind = (_mdt == mtRelay) ? ctx->relayNameIndex : ctx->switchNameIndex;
+  if (ind.size == 0)
+  {
+    return (-1);
+  }
 
-  if ((index >= 0) && (index < relayCount))
+  uint16_t pos = _hash & (ind.size - 1);
+  for (uint16_t i = 0; i < ind.size && ind.slots[pos] >= 0; i++)
   {
-    bool state = digitalRead(relayArray[index].relayPin);
-    if (!relayArray[index].relayControlLevel)
+    int16_t index = ind.slots[pos];
+    uint32_t hash = (_mdt == mtRelay) ? ctx->relayArray[index].relayNameHash
+                                      : ctx->switchArray[index].relayNameHash;
+    if (hash == _hash)
     {
-      state = !state;
+      // при поиске по имени дополнительно сравниваем строки на случай коллизии хэшей
+      const String &name = (_mdt == mtRelay) ? ctx->relayArray[index].relayName
+                                             : ctx->switchArray[index].relayName;
+      if (!_name || strcmp(name.c_str(), _name) == 0)
+      {
+        return (index);
+      }
     }
-    result = (state) ? sr_on_str : sr_off_str;
+    pos = (pos + 1) & (ind.size - 1);
+  }
+
+  return (-1);
+}
+
+static uint8_t get_command_code(const char *_comm)
+{
+  uint8_t result = cmUnknown;
+  if (strcmp_P(_comm, sr_respond_str) == 0)
+  {
+    result = cmRespond;
+  }
+  else if (strcmp_P(_comm, sr_switch_str) == 0)
+  {
+    result = cmSwitch;
+  }
+  else if (strcmp_P(_comm, sr_set_on_str) == 0)
+  {
+    result = cmSetOn;
+  }
+  else if (strcmp_P(_comm, sr_set_off_str) == 0)
+  {
+    result = cmSetOff;
+  }
+  else if (strcmp_P(_comm, sr_subscribe_str) == 0)
+  {
+    result = cmSubscribe;
+  }
+  else if (strcmp_P(_comm, sr_notify_str) == 0)
+  {
+    result = cmNotify;
+  }
+
+  return (result);
+}
+
+static const __FlashStringHelper *get_command_str(uint8_t _comm)
+{
+  switch (_comm)
+  {
+  case cmRespond:
+    return (FPSTR(sr_respond_str));
+  case cmSwitch:
+    return (FPSTR(sr_switch_str));
+  case cmSetOn:
+    return (FPSTR(sr_set_on_str));
+  case cmSetOff:
+    return (FPSTR(sr_set_off_str));
+  case cmSubscribe:
+    return (FPSTR(sr_subscribe_str));
+  case cmNotify:
+    return (FPSTR(sr_notify_str));
+  default:
+    return (FPSTR(sr_empty_str));
+  }
+}
+
+static uint8_t get_response_code(const char *_resp)
+{
+  uint8_t result = rsUnknown;
+  if (strcmp_P(_resp, sr_on_str) == 0)
+  {
+    result = rsOn;
+  }
+  else if (strcmp_P(_resp, sr_off_str) == 0)
+  {
+    result = rsOff;
+  }
+  else if (strcmp_P(_resp, sr_ok_str) == 0)
+  {
+    result = rsOk;
+  }
+
+  return (result);
+}
+
+static const __FlashStringHelper *get_response_str(uint8_t _resp)
+{
+  switch (_resp)
+  {
+  case rsOff:
+    return (FPSTR(sr_off_str));
+  case rsOn:
+    return (FPSTR(sr_on_str));
+  case rsOk:
+    return (FPSTR(sr_ok_str));
+  default:
+    return (FPSTR(sr_unknown_str));
+  }
+}
+
+static const __FlashStringHelper *get_state_str(bool _state)
+{
+  return ((_state) ? FPSTR(sr_on_str) : FPSTR(sr_off_str));
+}
+
+static size_t get_bin_packet_to_send(uint8_t *buf,
+                                     size_t bufSize,
+                                     uint8_t _op,
+                                     uint8_t _flags,
+                                     uint16_t _seq,
+                                     uint32_t _hash)
+{
+  if (bufSize < SR_BIN_HEADER_SIZE)
+  {
+    return (0);
   }
+
+  buf[0] = SR_BIN_MAGIC;
+  buf[1] = SR_PROTO_VERSION;
+  buf[2] = _op;
+  buf[3] = _flags;
+  buf[4] = _seq & 0xFF;
+  buf[5] = (_seq >> 8) & 0xFF;
+  set_bin_uint32(buf + 6, _hash);
+  size_t result = SR_BIN_HEADER_SIZE;
+
+  // к команде с номером добавляется сеанс выключателя - сразу за заголовком, до целей групповой команды
+  if (_seq != 0 && !(_flags & bfReply) && ctx->session != 0)
+  {
+    uint8_t data[4];
+    set_bin_uint32(data, ctx->session);
+    result = add_bin_field(buf, result, bufSize, pfSession, data, sizeof(data));
+  }
+
   return (result);
 }
 
-static void switch_remote_relay(int8_t index)
+static size_t add_bin_field(uint8_t *buf,
+                            size_t pos,
+                            size_t bufSize,
+                            uint8_t _field,
+                            const uint8_t *data,
+                            size_t len)
+{
+  // длина поля не более 255 байт и не больше оставшегося места в буфере
+  if (len > 255)
+  {
+    len = 255;
+  }
+  if (pos + 2 > bufSize)
+  {
+    return (pos);
+  }
+  if (pos + 2 + len > bufSize)
+  {
+    len = bufSize - pos - 2;
+  }
+
+  buf[pos++] = _field;
+  buf[pos++] = len;
+  memcpy(buf + pos, data, len);
+
+  return (pos + len);
+}
+
+static void send_response(const IPAddress &address,
+                          const String &_name,
+                          const String &_descr,
+                          uint8_t _resp,
+                          uint8_t _for,
+                          bool _binary,
+                          uint16_t _seq)
 {
-  send_command_for_relay(index, sr_switch_str);
+  if (!_binary)
+  {
+    size_t len = get_json_packet_to_send(_name, _descr, _resp, _for);
+    send_udp_packet(address, packet_buf, len);
+    return;
+  }
+
+  uint8_t *buf = packet_buf;
+  size_t len = get_bin_packet_to_send(buf,
+                                      sizeof(packet_buf),
+                                      _for,
+                                      bfReply,
+                                      _seq,
+                                      get_name_hash(_name.c_str()));
+  len = add_bin_field(buf, len, sizeof(packet_buf), pfResp, &_resp, 1);
+
+  // имя и описание передаются только в ответ на поиск и на неизвестную команду;
+  // в ответ на команды переключения достаточно хэша имени
+  if (_for == cmRespond || _for == cmUnknown)
+  {
+    len = add_bin_field(buf, len, sizeof(packet_buf), pfName,
+                        (const uint8_t *)_name.c_str(), _name.length());
+    len = add_bin_field(buf, len, sizeof(packet_buf), pfDescr,
+                        (const uint8_t *)_descr.c_str(), _descr.length());
+  }
+
+  send_udp_packet(address, buf, len);
 }
 
-static void set_remote_relay_state(int8_t index, bool state)
+static bool get_value_of_argument(String &_res, const String &_arg, String &_str)
 {
-  String _str = (state) ? sr_set_on_str : sr_set_off_str;
-  send_command_for_relay(index, _str);
+  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+
+  DeserializationError error = deserializeJson(doc, _res);
+  bool result = !error;
+  if (result)
+  {
+    result = doc[_arg].as<String>() != "null";
+  }
+  else
+  {
+    SR_PRINTLN(F("invalid response data"));
+    SR_PRINTLN(error.f_str());
+  }
+
+  if (result)
+  {
+    _str = doc[_arg].as<String>();
+  }
+
+  return result;
+}
+
+static bool send_udp_packet(const IPAddress &address, const uint8_t *buf, size_t bufSize)
+{
+  bool result = (bufSize > 0) && ctx->udp->beginPacket(address, ctx->localPort);
+
+  if (result)
+  {
+    ctx->udp->write(buf, bufSize);
+    result = ctx->udp->endPacket() == 1;
+  }
+
+  if (!result)
+  {
+    SR_PRINT(F("Error sending UDP packet for IP "));
+    SR_PRINT(address);
+    SR_PRINT(F(", remote port: "));
+    SR_PRINTLN((String)ctx->localPort);
+  }
+
+  return (result);
+}
+
+static String get_argument(String &_res, const String &_arg)
+{
+  String result = "";
+  get_value_of_argument(_res, _arg, result);
+  return result;
+}
+
+static size_t serialize_to_packet_buf(JsonDocument &doc)
+{
+  // последний байт буфера занимает завершающий ноль
+  if (doc.overflowed() || measureJson(doc) >= sizeof(packet_buf))
+  {
+    SR_PRINTLN(F("Outgoing packet is too large, not sent"));
+    return (0);
+  }
+
+  return (serializeJson(doc, (char *)packet_buf, sizeof(packet_buf)));
+}
+
+static size_t get_json_packet_to_send(const String &_name,
+                                      const String &_descr,
+                                      uint8_t _resp,
+                                      uint8_t _for)
+{
+  // строковые значения передаются указателями, без копирования в документ
+  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+
+  doc[FPSTR(sr_name_str)] = _name.c_str();
+  doc[FPSTR(sr_descr_str)] = _descr.c_str();
+  doc[FPSTR(sr_for_str)] = get_command_str(_for);
+  doc[FPSTR(sr_response_str)] = get_response_str(_resp);
+
+  return (serialize_to_packet_buf(doc));
+}
+
+static size_t get_json_packet_to_send(const String &_name, uint8_t _comm)
+{
+  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+
+  doc[FPSTR(sr_name_str)] = _name.c_str();
+  doc[FPSTR(sr_command_str)] = get_command_str(_comm);
+  doc[FPSTR(sr_proto_str)] = SR_PROTO_VERSION;
+
+  return (serialize_to_packet_buf(doc));
+}
+
+static size_t get_json_packet_to_send(uint8_t _comm)
+{
+  // команда для всех реле
+  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+
+  doc[FPSTR(sr_name_str)] = FPSTR(sr_any_str);
+  doc[FPSTR(sr_command_str)] = get_command_str(_comm);
+  doc[FPSTR(sr_proto_str)] = SR_PROTO_VERSION;
+
+  return (serialize_to_packet_buf(doc));
+}
+
+static void switch_local_relay(int16_t index)
+{
+  if ((index >= 0) && (index < ctx->relayCount))
+  {
+    set_local_relay_state(index, !get_relay_state(index));
+  }
+}
+
+static void set_local_relay_state(int16_t index, bool state)
+{
+  if ((index >= 0) && (index < ctx->relayCount))
+  {
+    uint8_t bit = 1 << (index & 7);
+    bool last = ctx->relay_state[index >> 3] & bit;
+    if (state)
+    {
+      ctx->relay_state[index >> 3] |= bit;
+    }
+    else
+    {
+      ctx->relay_state[index >> 3] &= ~bit;
+    }
+    ctx->output_mask[index >> 3] |= bit;
+    if (!ctx->output_batch)
+    {
+      commit_relay_outputs();
+    }
+    if (state != last)
+    {
+      ctx->relayArray[index].relayVersion = ++ctx->state_version;
+      // подписчики уведомляются только о действительных изменениях состояния
+      ctx->notify_mask[index >> 3] |= bit;
+      ctx->notify_pending = true;
+    }
+    if (ctx->save_state_of_relay && !ctx->relay_state_dirty)
+    {
+      // само сохранение выполняется позже в tick(), чтобы объединить несколько изменений в одну запись
+      ctx->relay_state_dirty = true;
+      ctx->save_state_timer = millis();
+    }
+
+    SR_PRINT(ctx->relayArray[index].relayName);
+    SR_PRINT(F(": state - "));
+    SR_PRINTLN(get_state_str(state));
+  }
+}
+
+static bool apply_local_command(int16_t index, uint8_t comm)
+{
+  if (comm == cmSwitch)
+  {
+    switch_local_relay(index);
+  }
+  else if ((comm == cmSetOn) || (comm == cmSetOff))
+  {
+    set_local_relay_state(index, (comm == cmSetOn));
+  }
+
+  return (get_relay_state(index));
+}
+
+static void apply_multi_command(const srMessage &msg)
+{
+  // ответ собирается по ходу выполнения команд: для каждой цели - ее текущее состояние
+  size_t len = get_bin_packet_to_send(packet_buf,
+                                      sizeof(packet_buf),
+                                      cmUnknown,
+                                      bfReply | bfMulti,
+                                      msg.seq,
+                                      0);
+  // все изменения переносятся на выходы одной записью после выполнения всех команд
+  ctx->output_batch = true;
+  for (uint8_t i = 0; i < msg.targetCount; i++)
+  {
+    const uint8_t *target = msg.targets + i * (SR_BIN_TARGET_SIZE + 2) + 2;
+    uint32_t hash = get_bin_uint32(target);
+    int16_t index = find_in_name_index(mtRelay, hash, NULL);
+    if (index < 0)
+    {
+      continue;
+    }
+
+    uint8_t data[SR_BIN_TARGET_SIZE];
+    set_bin_uint32(data, hash);
+    bool state = (msg.duplicate) ? get_relay_state(index)
+                                 : apply_local_command(index, target[4]);
+    data[4] = (state) ? rsOn : rsOff;
+    len = add_bin_field(packet_buf, len, sizeof(packet_buf), pfTarget, data, SR_BIN_TARGET_SIZE);
+  }
+  ctx->output_batch = false;
+  commit_relay_outputs();
+
+  send_udp_packet(ctx->udp->remoteIP(), packet_buf, len);
+}
+
+static bool flush_relay_state(bool _force)
+{
+  if (!ctx->relay_state_dirty ||
+      (!_force && millis() - ctx->save_state_timer < ctx->save_state_delay))
+  {
+    return (true);
+  }
+
+  // изменения дописываются в журнал; когда журнал разрастется, он переносится в файл настроек;
+  // после неудачной записи в журнал дописывать его нельзя - при восстановлении чтение остановится
+  // на недописанной записи, и все следующие записи будут потеряны, поэтому состояние сразу
+  // переносится в файл настроек
+  bool result = (ctx->journal_records >= SR_JOURNAL_MAX_RECORDS || ctx->journal_failed)
+                    ? save_config_file(mtRelay)
+                    : append_relay_journal();
+  // если записать не удалось, изменения остаются несохраненными и запись повторится через интервал
+  if (result)
+  {
+    ctx->relay_state_dirty = false;
+  }
+  else
+  {
+    ctx->save_state_timer = millis();
+  }
+
+  return (result);
+}
+
+static String get_journal_file_name()
+{
+  // журнал лежит рядом с файлом настроек: /relay.json -> /relay.jrn
+  String result = ctx->relayFileConfigName;
+  if (result.endsWith(".json"))
+  {
+    result = result.substring(0, result.length() - 5);
+  }
+  result += ".jrn";
+
+  return (result);
+}
+
+static bool append_relay_journal()
+{
+  if (!ctx->file_system)
+  {
+    return (false);
+  }
+
+  File journal;
+  bool result = true;
+  for (int16_t i = 0; i < ctx->relayCount && result; i++)
+  {
+    // в журнал попадают только реле, состояние которых отличается от сохраненного
+    if (get_relay_state(i) == ctx->relayArray[i].relaySavedState)
+    {
+      continue;
+    }
+    if (!journal)
+    {
+      // новый журнал начинается с заголовка с номером текущей версии файла настроек
+      journal = ctx->file_system->open(get_journal_file_name(), (ctx->journal_header) ? "a" : "w");
+      if (!journal)
+      {
+        SR_PRINTLN(F("Failed to open relay state journal"));
+        return (false);
+      }
+      if (!ctx->journal_header)
+      {
+        uint8_t hdr[SR_JOURNAL_HEADER_SIZE];
+        get_journal_header(hdr);
+        result = journal.write(hdr, SR_JOURNAL_HEADER_SIZE) == SR_JOURNAL_HEADER_SIZE;
+        ctx->journal_header = result;
+        if (!result)
+        {
+          break;
+        }
+      }
+    }
+
+    uint8_t rec[SR_JOURNAL_RECORD_SIZE] = {(uint8_t)(i & 0xFF),
+                                           (uint8_t)(((i >> 8) << 1) | get_relay_state(i)),
+                                           ctx->journal_seq,
+                                           0};
+    rec[3] = rec[0] ^ rec[1] ^ rec[2] ^ SR_JOURNAL_CHECK;
+    result = journal.write(rec, SR_JOURNAL_RECORD_SIZE) == SR_JOURNAL_RECORD_SIZE;
+    if (result)
+    {
+      ctx->relayArray[i].relaySavedState = rec[1] & 0x01;
+      ctx->journal_seq++;
+      ctx->journal_records++;
+    }
+  }
+  if (journal)
+  {
+    journal.close();
+  }
+  if (!result)
+  {
+    ctx->journal_failed = true;
+    SR_PRINTLN(F("Failed to write relay state journal"));
+  }
+
+  return (result);
+}
+
+static void get_journal_header(uint8_t *hdr)
+{
+  hdr[0] = 'J';
+  set_bin_uint32(hdr + 1, ctx->config_seq[mtRelay]);
+  hdr[5] = hdr[0] ^ hdr[1] ^ hdr[2] ^ hdr[3] ^ hdr[4] ^ SR_JOURNAL_CHECK;
+}
+
+static bool replay_relay_journal()
+{
+  ctx->journal_records = 0;
+  ctx->journal_seq = 0;
+  ctx->journal_header = false;
+  ctx->journal_failed = false;
+
+  String fileName = get_journal_file_name();
+  if (!ctx->file_system || !ctx->file_system->exists(fileName))
+  {
+    return (false);
+  }
+
+  File journal = ctx->file_system->open(fileName, "r");
+  if (!journal)
+  {
+    return (false);
+  }
+
+  // журнал, записанный для другой версии файла настроек, остался от записи настроек,
+  // прерванной до удаления журнала; его записи старше загруженных настроек и не применяются
+  size_t size = journal.size();
+  uint8_t hdr[SR_JOURNAL_HEADER_SIZE];
+  uint8_t check[SR_JOURNAL_HEADER_SIZE];
+  get_journal_header(check);
+  if (journal.read(hdr, SR_JOURNAL_HEADER_SIZE) != SR_JOURNAL_HEADER_SIZE ||
+      memcmp(hdr, check, SR_JOURNAL_HEADER_SIZE) != 0)
+  {
+    journal.close();
+    SR_PRINTLN(F("Relay state journal does not match the settings file and is ignored"));
+    clear_relay_journal();
+    return (false);
+  }
+  ctx->journal_header = true;
+
+  uint8_t rec[SR_JOURNAL_RECORD_SIZE];
+  while (journal.read(rec, SR_JOURNAL_RECORD_SIZE) == SR_JOURNAL_RECORD_SIZE)
+  {
+    // останавливаемся на первой поврежденной или недописанной записи
+    if (rec[2] != ctx->journal_seq ||
+        rec[3] != (rec[0] ^ rec[1] ^ rec[2] ^ SR_JOURNAL_CHECK))
+    {
+      break;
+    }
+    int16_t index = rec[0] | ((rec[1] >> 1) << 8);
+    if (index < ctx->relayCount)
+    {
+      ctx->relayArray[index].relayLastState = rec[1] & 0x01;
+      ctx->relayArray[index].relaySavedState = ctx->relayArray[index].relayLastState;
+    }
+    ctx->journal_seq++;
+    ctx->journal_records++;
+  }
+  journal.close();
+
+  SR_PRINT(F("Relay state journal, records restored: "));
+  SR_PRINTLN(ctx->journal_records);
+
+  // хвост журнала поврежден - восстановленное состояние нужно перенести в файл настроек,
+  // иначе новые записи окажутся после поврежденной и будут потеряны
+  return (SR_JOURNAL_HEADER_SIZE + (size_t)ctx->journal_records * SR_JOURNAL_RECORD_SIZE != size);
+}
+
+static void clear_relay_journal()
+{
+  String fileName = get_journal_file_name();
+  if (ctx->file_system && ctx->file_system->exists(fileName))
+  {
+    ctx->file_system->remove(fileName);
+  }
+  ctx->journal_records = 0;
+  ctx->journal_seq = 0;
+  ctx->journal_header = false;
+  ctx->journal_failed = false;
+}
+
+static void mark_relay_state_saved()
+{
+  for (int16_t i = 0; i < ctx->relayCount; i++)
+  {
+    ctx->relayArray[i].relaySavedState = get_relay_state(i);
+  }
+  ctx->relay_state_dirty = false;
+}
+
+static bool get_relay_state(int16_t index)
+{
+  bool result = false;
+
+  if ((index >= 0) && (index < ctx->relayCount))
+  {
+    result = ctx->relay_state[index >> 3] & (1 << (index & 7));
+  }
+  return (result);
+}
+
+static void commit_relay_outputs()
+{
+  // драйверы только накапливают новые уровни выходов, а на выходы переносят их в commit() -
+  // одной записью в регистры или одной транзакцией на шине для всех реле драйвера
+  for (int16_t i = 0; i < ctx->relayCount; i++)
+  {
+    if (ctx->output_mask[i >> 3] & (1 << (i & 7)))
+    {
+      shRelayData &relay = ctx->relayArray[i];
+      bool level = (relay.relayControlLevel) ? get_relay_state(i) : !get_relay_state(i);
+      get_relay_driver(i)->stageChannel(relay.relayPin, level);
+    }
+  }
+  // commit() вызывается один раз для каждого драйвера, сколько бы его реле ни изменилось
+  for (int16_t i = 0; i < ctx->relayCount; i++)
+  {
+    if (ctx->output_mask[i >> 3] & (1 << (i & 7)))
+    {
+      get_relay_driver(i)->commitStaged();
+    }
+  }
+  memset(ctx->output_mask, 0, sizeof(ctx->output_mask));
+}
+
+static srRelayDriver *get_relay_driver(int16_t index)
+{
+  srRelayDriver *drv = ctx->relayArray[index].relayDriver;
+
+  return ((drv) ? drv : &gpio_driver);
+}
+
+static void switch_remote_relay(int16_t index)
+{
+  send_command_for_relay(index, cmSwitch);
+}
+
+static void set_remote_relay_state(int16_t index, bool state)
+{
+  send_command_for_relay(index, (state) ? cmSetOn : cmSetOff);
+}
+
+static void set_all_remote_relay_state(bool state)
+{
+  if (WiFi.isConnected())
+  {
+    IPAddress discoveryAddress = get_discovery_address();
+
+    uint8_t comm = (state) ? cmSetOn : cmSetOff;
+    size_t len = get_json_packet_to_send(comm);
+    SR_PRINT(F("Sending a request to set the state for all remote relays: "));
+    SR_PRINTLN(get_command_str(comm));
+    SR_PRINT(F("Discovery address: "));
+    SR_PRINTLN(discoveryAddress);
+    send_udp_packet(discoveryAddress, packet_buf, len);
+  }
+  else
+  {
+    ctx->bzr.startBuzzer(3);
+    SR_PRINTLN(F("Failed to send command to remote relay, connection lost"));
+  }
+}
+
+static void send_command_for_relay(int16_t index, uint8_t command)
+{
+  // реле модуля реле этой же прошивки переключается напрямую, без обращения к сети
+  if (find_local_relay(index))
+  {
+    send_local_command(index, command);
+  }
+  else if (WiFi.isConnected())
+  {
+    if ((index >= 0) &&
+        (index < ctx->switchCount) &&
+        (ctx->switchArray[index].relayName != emptyString))
+    {
+      if (ctx->switchArray[index].relayFound)
+      {
+        SR_PRINTLN(F("Sending a command to remote relay"));
+        SR_PRINT(F("Relay name: "));
+        SR_PRINT(ctx->switchArray[index].relayName);
+        SR_PRINT(F("; IP: "));
+        SR_PRINT(ctx->switchArray[index].relayAddress);
+        SR_PRINT(F("; command: "));
+        SR_PRINTLN(get_command_str(command));
+        if (ctx->switchArray[index].relayProto >= SR_PROTO_VERSION)
+        {
+          // команда с номером остается в очереди до подтверждения; предыдущая неподтвержденная
+          // команда этому реле новой командой заменяется
+          ctx->switchArray[index].pendingCommand = command;
+          ctx->switchArray[index].pendingSeq = get_next_command_seq();
+          ctx->switchArray[index].pendingRetries = 0;
+          send_bin_command(index);
+        }
+        else
+        {
+          size_t len = get_json_packet_to_send(ctx->switchArray[index].relayName,
+                                               command);
+          send_udp_packet(ctx->switchArray[index].relayAddress, packet_buf, len);
+        }
+      }
+      else
+      {
+        ctx->bzr.startBuzzer(2);
+        SR_PRINT(F("Relay "));
+        SR_PRINT(ctx->switchArray[index].relayName);
+        SR_PRINTLN(F(" not found!"));
+        send_relay_probe(index, get_discovery_address());
+      }
+    }
+  }
+  else
+  {
+    ctx->bzr.startBuzzer(3);
+    SR_PRINTLN(F("Failed to send command to remote relay, connection lost"));
+  }
+}
+
+static void send_multi_command(const uint8_t *mask, const uint8_t *states)
+{
+  bool connected = WiFi.isConnected();
+  bool failed = false;
+
+  // mask - реле, которым нужно отправить команду, states - нужное состояние, по биту на реле;
+  // отметки реле, команда для которых уже отправлена, - там же, в копии маски
+  uint8_t sent[SR_MASK_SIZE];
+  for (uint16_t i = 0; i < sizeof(sent); i++)
+  {
+    sent[i] = ~mask[i];
+  }
+  for (int16_t i = 0; i < ctx->switchCount; i++)
+  {
+    if (sent[i >> 3] & (1 << (i & 7)))
+    {
+      continue;
+    }
+
+    // реле этой же прошивки переключаются напрямую, остальным нужна сеть
+    if (find_local_relay(i))
+    {
+      send_local_command(i, (states[i >> 3] & (1 << (i & 7))) ? cmSetOn : cmSetOff);
+      continue;
+    }
+    if (!connected)
+    {
+      failed = true;
+      continue;
+    }
+
+    // старые модули и ненайденные реле - по одной команде, как раньше
+    if (!ctx->switchArray[i].relayFound || ctx->switchArray[i].relayProto < SR_PROTO_VERSION)
+    {
+      send_command_for_relay(i, (states[i >> 3] & (1 << (i & 7))) ? cmSetOn : cmSetOff);
+      continue;
+    }
+
+    // все найденные реле того же модуля собираем в один пакет
+    IPAddress address = ctx->switchArray[i].relayAddress;
+    SR_PRINT(F("Sending a group command to remote relays; IP: "));
+    SR_PRINTLN(address);
+
+    uint16_t seq = get_next_command_seq();
+    size_t len = get_bin_packet_to_send(packet_buf, sizeof(packet_buf), cmUnknown, bfMulti, seq, 0);
+    for (int16_t j = i; j < ctx->switchCount; j++)
+    {
+      if ((sent[j >> 3] & (1 << (j & 7))) ||
+          !ctx->switchArray[j].relayFound ||
+          ctx->switchArray[j].relayProto < SR_PROTO_VERSION ||
+          !(ctx->switchArray[j].relayAddress == address))
+      {
+        continue;
+      }
+      // пакет заполнен - отправляем его и начинаем следующий
+      if (len + SR_BIN_TARGET_SIZE + 2 > sizeof(packet_buf))
+      {
+        send_udp_packet(address, packet_buf, len);
+        seq = get_next_command_seq();
+        len = get_bin_packet_to_send(packet_buf, sizeof(packet_buf), cmUnknown, bfMulti, seq, 0);
+      }
+
+      uint8_t comm = (states[j >> 3] & (1 << (j & 7))) ? cmSetOn : cmSetOff;
+      uint8_t data[SR_BIN_TARGET_SIZE];
+      set_bin_uint32(data, ctx->switchArray[j].relayNameHash);
+      data[4] = comm;
+      len = add_bin_field(packet_buf, len, sizeof(packet_buf), pfTarget, data, SR_BIN_TARGET_SIZE);
+      ctx->switchArray[j].pendingCommand = comm;
+      ctx->switchArray[j].pendingSeq = seq;
+      ctx->switchArray[j].pendingRetries = 0;
+      ctx->switchArray[j].pendingTimer = millis();
+      sent[j >> 3] |= 1 << (j & 7);
+    }
+    send_udp_packet(address, packet_buf, len);
+  }
+
+  if (failed)
+  {
+    ctx->bzr.startBuzzer(3);
+    SR_PRINTLN(F("Failed to send command to remote relay, connection lost"));
+  }
+}
+
+static uint16_t get_next_command_seq()
+{
+  // номер 0 означает команду без номера, поэтому пропускается
+  if (++ctx->command_seq == 0)
+  {
+    ctx->command_seq = 1;
+  }
+
+  return (ctx->command_seq);
+}
+
+static void send_bin_command(int16_t index)
+{
+  size_t len = get_bin_packet_to_send(packet_buf,
+                                      sizeof(packet_buf),
+                                      ctx->switchArray[index].pendingCommand,
+                                      0,
+                                      ctx->switchArray[index].pendingSeq,
+                                      ctx->switchArray[index].relayNameHash);
+  send_udp_packet(ctx->switchArray[index].relayAddress, packet_buf, len);
+  ctx->switchArray[index].pendingTimer = millis();
+}
+
+static bool retry_pending_commands()
+{
+  bool result = false;
+  for (int16_t i = 0; i < ctx->switchCount; i++)
+  {
+    shSwitchData &data = ctx->switchArray[i];
+    // интервал ожидания удваивается с каждым повтором
+    if (data.pendingCommand == 0 ||
+        millis() - data.pendingTimer < ((uint32_t)ctx->command_timeout << data.pendingRetries))
+    {
+      continue;
+    }
+
+    if (data.pendingRetries >= ctx->command_retries)
+    {
+      // реле не отвечает - считаем его ненайденным, при следующей проверке оно будет найдено заново
+      data.pendingCommand = 0;
+      data.commandFailed++;
+      data.relayFound = false;
+      ctx->bzr.startBuzzer(2);
+      SR_PRINT(data.relayName);
+      SR_PRINTLN(F(": command not confirmed"));
+      continue;
+    }
+
+    // команды set_on/set_off при повторе выполнять дважды не страшно, поэтому им дается новый номер:
+    // иначе цель групповой команды, повторяемая отдельным пакетом, была бы отброшена как повтор
+    if (data.pendingCommand != cmSwitch)
+    {
+      data.pendingSeq = get_next_command_seq();
+    }
+    data.pendingRetries++;
+    SR_PRINT(data.relayName);
+    SR_PRINT(F(": retry command, attempt "));
+    SR_PRINTLN(data.pendingRetries);
+    send_bin_command(i);
+    result = true;
+  }
+
+  return (result);
+}
+
+static void confirm_command(int16_t index, uint16_t _seq)
+{
+  if (_seq != 0 &&
+      ctx->switchArray[index].pendingCommand != 0 &&
+      ctx->switchArray[index].pendingSeq == _seq)
+  {
+    ctx->switchArray[index].pendingCommand = 0;
+    ctx->switchArray[index].commandSuccess++;
+  }
+}
+
+static bool is_duplicate_command(const IPAddress &address, uint32_t _session, uint16_t _seq)
+{
+  if (_seq == 0)
+  {
+    return (false);
+  }
+
+  // ищем окно отправителя; окна, не обновлявшиеся дольше SR_DEDUPE_TTL, освобождаются;
+  // для нового отправителя занимаем свободное окно или окно самого давнего
+  uint32_t now = millis();
+  int8_t n = -1;
+  uint8_t oldest = 0;
+  for (uint8_t i = 0; i < SR_DEDUPE_SENDERS && n < 0; i++)
+  {
+    srSenderWindow &sw = ctx->sender_window[i];
+    if (sw.window != 0 && now - sw.time > SR_DEDUPE_TTL)
+    {
+      sw.window = 0;
+    }
+    if (sw.window != 0 && sw.address == address && sw.session == _session)
+    {
+      n = i;
+    }
+    else if (ctx->sender_window[oldest].window != 0 &&
+             (sw.window == 0 || sw.time < ctx->sender_window[oldest].time))
+    {
+      oldest = i;
+    }
+  }
+
+  if (n < 0)
+  {
+    srSenderWindow &sw = ctx->sender_window[oldest];
+    sw.address = address;
+    sw.session = _session;
+    sw.lastSeq = _seq;
+    sw.window = 1;
+    sw.time = now;
+    return (false);
+  }
+
+  srSenderWindow &sw = ctx->sender_window[n];
+  sw.time = now;
+  int16_t diff = (int16_t)(_seq - sw.lastSeq);
+  if (diff > 0 || -diff >= 16)
+  {
+    // новый номер - сдвигаем окно; далеко назад номер уходит только при новой нумерации
+    // (отправитель без сеанса перезагрузился), такое окно начинается заново
+    sw.window = (diff > 0 && diff < 16) ? (sw.window << diff) | 1 : 1;
+    sw.lastSeq = _seq;
+    return (false);
+  }
+
+  uint16_t bit = 1 << (-diff);
+  bool result = sw.window & bit;
+  sw.window |= bit;
+
+  return (result);
+}
+
+static uint32_t get_random_uint32()
+{
+#if defined(ARDUINO_ARCH_ESP8266)
+  return (RANDOM_REG32);
+#else
+  return (esp_random());
+#endif
+}
+
+static void add_subscriber(const IPAddress &address, bool _binary)
+{
+  // продлеваем существующую подписку
+  int8_t n = -1;
+  for (uint8_t i = 0; i < SR_MAX_SUBSCRIBERS && n < 0; i++)
+  {
+    if (ctx->subscribers[i].active && ctx->subscribers[i].address == address)
+    {
+      n = i;
+    }
+  }
+
+  // иначе занимаем свободное место или место самой старой подписки
+  if (n < 0)
+  {
+    n = 0;
+    for (uint8_t i = 0; i < SR_MAX_SUBSCRIBERS; i++)
+    {
+      if (!ctx->subscribers[i].active)
+      {
+        n = i;
+        break;
+      }
+      if (millis() - ctx->subscribers[i].time > millis() - ctx->subscribers[n].time)
+      {
+        n = i;
+      }
+    }
+  }
+
+  ctx->subscribers[n].address = address;
+  ctx->subscribers[n].time = millis();
+  ctx->subscribers[n].binary = _binary;
+  ctx->subscribers[n].active = true;
+}
+
+static void notify_subscribers()
+{
+  for (uint8_t s = 0; s < SR_MAX_SUBSCRIBERS; s++)
+  {
+    srSubscriber &sub = ctx->subscribers[s];
+    if (sub.active && millis() - sub.time >= ctx->subscription_lease)
+    {
+      SR_PRINT(F("Subscription expired: "));
+      SR_PRINTLN(sub.address);
+      sub.active = false;
+    }
+    if (!sub.active)
+    {
+      continue;
+    }
+
+    if (sub.binary)
+    {
+      // все изменения - одним пакетом; если реле много и пакет заполнен, отправляем его и начинаем следующий
+      size_t len = 0;
+      for (int16_t i = 0; i < ctx->relayCount; i++)
+      {
+        if (!(ctx->notify_mask[i >> 3] & (1 << (i & 7))))
+        {
+          continue;
+        }
+        if (len > 0 && len + SR_BIN_TARGET_SIZE + 2 > sizeof(packet_buf))
+        {
+          send_udp_packet(sub.address, packet_buf, len);
+          len = 0;
+        }
+        if (len == 0)
+        {
+          len = get_bin_packet_to_send(packet_buf, sizeof(packet_buf), cmNotify, bfReply | bfMulti, 0, 0);
+        }
+        uint8_t data[SR_BIN_TARGET_SIZE];
+        set_bin_uint32(data, ctx->relayArray[i].relayNameHash);
+        data[4] = (get_relay_state(i)) ? rsOn : rsOff;
+        len = add_bin_field(packet_buf, len, sizeof(packet_buf), pfTarget, data, SR_BIN_TARGET_SIZE);
+      }
+      send_udp_packet(sub.address, packet_buf, len);
+    }
+    else
+    {
+      // старые модули понимают только JSON - по пакету на каждое реле
+      for (int16_t i = 0; i < ctx->relayCount; i++)
+      {
+        if (ctx->notify_mask[i >> 3] & (1 << (i & 7)))
+        {
+          send_response(sub.address,
+                        ctx->relayArray[i].relayName,
+                        ctx->relayArray[i].relayDescription,
+                        (get_relay_state(i)) ? rsOn : rsOff,
+                        cmNotify,
+                        false,
+                        0);
+        }
+      }
+    }
+  }
+}
+
+static void publish_relay_changes()
+{
+  if (ctx->notify_pending)
+  {
+    ctx->notify_pending = false;
+    notify_subscribers();
+    send_relay_events(false);
+    memset(ctx->notify_mask, 0, sizeof(ctx->notify_mask));
+  }
+  else if (millis() - ctx->event_timer >= SR_EVENT_KEEPALIVE)
+  {
+    send_relay_events(true);
+  }
+}
+
+static void send_relay_events(bool _keepalive)
+{
+  ctx->event_timer = millis();
+
+  // событие - объект вида {"индекс реле":состояние,...}, только для изменившихся реле
+  String data = "";
+  if (_keepalive)
+  {
+    data = F(":\n\n");
+  }
+  else
+  {
+    data.reserve(16 + ctx->relayCount * 8);
+    data = F("data: {");
+    for (int16_t i = 0; i < ctx->relayCount; i++)
+    {
+      if (ctx->notify_mask[i >> 3] & (1 << (i & 7)))
+      {
+        if (data.length() > 7)
+        {
+          data += ',';
+        }
+        data += '"';
+        data += i;
+        data += F("\":");
+        data += (get_relay_state(i)) ? '1' : '0';
+      }
+    }
+    data += F("}\n\n");
+  }
+
+  for (uint8_t i = 0; i < SR_MAX_EVENT_CLIENTS; i++)
+  {
+    if (ctx->event_clients[i] && !write_relay_event(ctx->event_clients[i], data))
+    {
+      ctx->event_clients[i].stop();
+      ctx->event_clients[i] = WiFiClient();
+    }
+  }
+}
+
+static bool write_relay_event(WiFiClient &client, const String &data)
+{
+  // запись не должна задерживать tick(): если в буфере передачи нет места, клиент не успевает
+  // забирать события; такой клиент отключается, а после повторного подключения получит
+  // состояние всех реле
+  if (!client.connected())
+  {
+    return (false);
+  }
+#if defined(ARDUINO_ARCH_ESP8266)
+  if ((size_t)client.availableForWrite() < data.length())
+  {
+    return (false);
+  }
+#else
+  // у WiFiClient esp32 нет размера свободного места в буфере, поэтому проверяется только,
+  // что запись в сокет сейчас возможна
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(client.fd(), &set);
+  timeval tv = {0, 0};
+  if (select(client.fd() + 1, NULL, &set, NULL, &tv) <= 0)
+  {
+    return (false);
+  }
+#endif
+
+  return (client.write((const uint8_t *)data.c_str(), data.length()) == data.length());
+}
+
+static void send_subscribe(int16_t index)
+{
+  size_t len = get_bin_packet_to_send(packet_buf,
+                                      sizeof(packet_buf),
+                                      cmSubscribe,
+                                      0,
+                                      0,
+                                      ctx->switchArray[index].relayNameHash);
+  send_udp_packet(ctx->switchArray[index].relayAddress, packet_buf, len);
+}
+
+static void set_remote_state(int16_t index, uint8_t _resp)
+{
+  if (_resp == rsOn || _resp == rsOff)
+  {
+    ctx->switchArray[index].relayState = (_resp == rsOn);
+  }
+}
+
+static void find_remote_relays()
+{
+  IPAddress discoveryAddress = get_discovery_address();
+
+  size_t len = get_json_packet_to_send(cmRespond);
+  SR_PRINTLN(F("Sending a request to check IP addresses of relays"));
+  SR_PRINT(F("Discovery address: "));
+  SR_PRINTLN(discoveryAddress);
+  send_udp_packet(discoveryAddress, packet_buf, len);
+  if (ctx->multicast_joined)
+  {
+    ctx->multicast_probe |= (discoveryAddress == ctx->multicast_group);
+    ctx->broadcast_probe |= (discoveryAddress != ctx->multicast_group);
+  }
+}
+
+static void receive_discovery_reply()
+{
+  // ответ любого модуля реле, а не только ненайденного: запрос поиска до модулей доходит, а
+  // после отказа от группы - широковещательный запрос находит реле, которых группа не нашла
+  ctx->multicast_probe = false;
+  ctx->broadcast_probe = false;
+  if (ctx->multicast_misses < SR_MULTICAST_MISSES)
+  {
+    ctx->multicast_misses = 0;
+  }
+}
+
+static void check_remote_relays(uint32_t _interval)
+{
+  if (!WiFi.isConnected())
+  {
+    return;
+  }
+
+  check_multicast_replies();
+
+  uint16_t missing = 0;
+  for (int16_t i = 0; i < ctx->switchCount; i++)
+  {
+    shSwitchData &data = ctx->switchArray[i];
+    // реле этой же прошивки по сети не опрашиваются
+    if (data.relayName == emptyString || find_local_relay(i))
+    {
+      continue;
+    }
+
+    if (data.relayFound && millis() - data.relayLastSeen >= ctx->relay_ttl)
+    {
+      data.relayFound = false;
+      SR_PRINT(data.relayName);
+      SR_PRINTLN(F(": no response, relay expired"));
+    }
+
+    if (!data.relayFound)
+    {
+      missing++;
+    }
+    else if (millis() - data.relayLastSeen >= _interval)
+    {
+      // реле давно не отвечало - опрашиваем его по известному адресу
+      send_relay_probe(i, data.relayAddress);
+    }
+  }
+
+  // продление подписки - один запрос на каждый модуль реле
+  if (ctx->subscribe_state)
+  {
+    for (int16_t i = 0; i < ctx->switchCount; i++)
+    {
+      if (!ctx->switchArray[i].relayFound ||
+          ctx->switchArray[i].relayProto < SR_PROTO_VERSION ||
+          ctx->switchArray[i].localModule >= 0)
+      {
+        continue;
+      }
+      bool sent = false;
+      for (int16_t j = 0; j < i && !sent; j++)
+      {
+        sent = ctx->switchArray[j].relayFound &&
+               ctx->switchArray[j].relayProto >= SR_PROTO_VERSION &&
+               ctx->switchArray[j].relayAddress == ctx->switchArray[i].relayAddress;
+      }
+      if (!sent)
+      {
+        send_subscribe(i);
+      }
+    }
+  }
+
+  // широковещательный запрос - только для ненайденных реле; если их много,
+  // один общий запрос обходится дешевле нескольких именных
+  if (missing > SR_NAMED_PROBE_MAX)
+  {
+    find_remote_relays();
+  }
+  else if (missing > 0)
+  {
+    IPAddress discoveryAddress = get_discovery_address();
+    for (int16_t i = 0; i < ctx->switchCount; i++)
+    {
+      if (!ctx->switchArray[i].relayFound && ctx->switchArray[i].relayName != emptyString)
+      {
+        send_relay_probe(i, discoveryAddress);
+      }
+    }
+  }
+}
+
+static void send_relay_probe(int16_t index, const IPAddress &address)
+{
+  SR_PRINT(F("Sending a request to check relay "));
+  SR_PRINT(ctx->switchArray[index].relayName);
+  SR_PRINT(F("; IP: "));
+  SR_PRINTLN(address);
+
+  // по известному адресу реле, понимающему бинарный протокол, запрос отправляется в бинарном виде;
+  // широковещательный запрос - в JSON, его понимают все модули
+  size_t len;
+  if (ctx->switchArray[index].relayFound && ctx->switchArray[index].relayProto >= SR_PROTO_VERSION)
+  {
+    len = get_bin_packet_to_send(packet_buf,
+                                 sizeof(packet_buf),
+                                 cmRespond,
+                                 0,
+                                 0,
+                                 ctx->switchArray[index].relayNameHash);
+  }
+  else
+  {
+    len = get_json_packet_to_send(ctx->switchArray[index].relayName, cmRespond);
+  }
+  send_udp_packet(address, packet_buf, len);
+}
+
+static void mark_relay_seen(int16_t index)
+{
+  ctx->switchArray[index].relayFound = true;
+  ctx->switchArray[index].relayLastSeen = millis();
+}
+
+static bool find_local_relay(int16_t index)
+{
+  if ((index < 0) ||
+      (index >= ctx->switchCount) ||
+      (ctx->switchArray[index].relayName == emptyString))
+  {
+    return (false);
+  }
+
+  shSwitchData &data = ctx->switchArray[index];
+  // найденный ранее маршрут проверяется по имени: реле могли переименовать через Web-интерфейс
+  if (data.localModule >= 0)
+  {
+    srContext *mdl = udp_modules[data.localModule];
+    if (mdl != NULL &&
+        data.localIndex < mdl->relayCount &&
+        mdl->relayArray[data.localIndex].relayNameHash == data.relayNameHash &&
+        mdl->relayArray[data.localIndex].relayName == data.relayName)
+    {
+      return (true);
+    }
+    data.localModule = -1;
+  }
+
+  // реле доступно напрямую, если его модуль работает в этой же прошивке на том же порту
+  srContext *current = ctx;
+  for (uint8_t m = 0; m < SR_MAX_UDP_MODULES && data.localModule < 0; m++)
+  {
+    if (udp_modules[m] == NULL ||
+        udp_modules[m]->type != mtRelay ||
+        udp_modules[m]->localPort != current->localPort)
+    {
+      continue;
+    }
+    ctx = udp_modules[m];
+    int16_t i = find_in_name_index(mtRelay, data.relayNameHash, data.relayName.c_str());
+    if (i >= 0)
+    {
+      data.localModule = m;
+      data.localIndex = i;
+      data.relayDescription = ctx->relayArray[i].relayDescription;
+    }
+  }
+  ctx = current;
+
+  if (data.localModule >= 0)
+  {
+    data.relayAddress = WiFi.localIP();
+    data.relayProto = SR_PROTO_VERSION;
+    data.pendingCommand = 0;
+    mark_relay_seen(index);
+    SR_PRINT(data.relayName);
+    SR_PRINTLN(F(" found in this firmware, commands are applied directly"));
+  }
+
+  return (data.localModule >= 0);
+}
+
+static void send_local_command(int16_t index, uint8_t command)
+{
+  shSwitchData &data = ctx->switchArray[index];
+  SR_PRINTLN(F("Sending a command to local relay"));
+  SR_PRINT(F("Relay name: "));
+  SR_PRINT(data.relayName);
+  SR_PRINT(F("; command: "));
+  SR_PRINTLN(get_command_str(command));
+
+  // команда выполняется с данными модуля реле так же, как пришедшая по сети: с сохранением
+  // состояния и уведомлением подписчиков и Web-страниц модуля реле
+  srContext *current = ctx;
+  ctx = udp_modules[data.localModule];
+  bool state = apply_local_command(data.localIndex, command);
+  ctx = current;
+
+  // результат обрабатывается так же, как ответ удаленного реле
+  mark_relay_seen(index);
+  receive_relay_response(index, (state) ? rsOn : rsOff, 0);
+}
+
+static void receive_relay_response(int16_t index, uint8_t _resp, uint16_t _seq)
+{
+  confirm_command(index, _seq);
+  set_remote_state(index, _resp);
+  SR_PRINT(ctx->switchArray[index].relayName);
+  SR_PRINT(F(" response - "));
+  SR_PRINTLN(get_response_str(_resp));
+}
+
+// ==== реакции сервера ==============================
+static void add_web_handler(const String &_uri, HTTPMethod _method, void (*_handler)())
+{
+  // обработчик выполняется с данными того экземпляра модуля, который его зарегистрировал
+  srContext *_ctx = ctx;
+  ctx->http_server->on(_uri, _method, [_ctx, _handler]()
+  {
+                       srContext *current = ctx;
+                       ctx = _ctx;
+                       _handler();
+                       ctx = current;
+  });
+}
+
+static void collect_page_headers()
+{
+  // сервер сохраняет только заголовки запроса, перечисленные заранее
+  static const char *headers[] = {"If-None-Match"};
+  ctx->http_server->collectHeaders(headers, 1);
+}
+
+static void send_gz_page(const uint8_t *page, size_t len, PGM_P etag)
+{
+  // страницы одинаковы для модулей реле и выключателя и хранятся во flash в сжатом виде;
+  // адрес настроек страница запрашивает сама, поэтому отдается без изменений и может кэшироваться браузером
+  ctx->http_server->sendHeader(F("ETag"), FPSTR(etag));
+  ctx->http_server->sendHeader(F("Cache-Control"), F("no-cache"));
+  if (strcmp_P(ctx->http_server->header(F("If-None-Match")).c_str(), etag) == 0)
+  {
+    ctx->http_server->send(304);
+    return;
+  }
+
+  ctx->http_server->sendHeader(F("Content-Encoding"), F("gzip"));
+  ctx->http_server->send_P(200, TEXT_HTML, (PGM_P)page, len);
+}
+
+static void handleGetConfigPage()
+{
+  send_gz_page(config_page_gz, config_page_gz_len, config_page_etag);
+}
+
+static void handleGetIndexPage()
+{
+  send_gz_page(index_page_gz, index_page_gz_len, index_page_etag);
+}
+
+static void get_relay_data_json(JsonObject &rel,
+                                const String &_name,
+                                const String &_descr,
+                                const int8_t _last)
+{
+  if (_last >= 0)
+  {
+    rel[FPSTR(sr_last_state_str)] = _last;
+  }
+  // строки передаются указателями, без копирования в документ
+  rel[FPSTR(sr_name_str)] = _name.c_str();
+  rel[FPSTR(sr_descr_str)] = _descr.c_str();
+}
+
+static void get_relay_data_json(JsonObject &rel,
+                                const String &_name,
+                                const String &_descr,
+                                const IPAddress _ip)
+{
+  rel[FPSTR(sr_name_str)] = _name.c_str();
+  rel[FPSTR(sr_descr_str)] = _descr.c_str();
+  rel[FPSTR(sr_ip_addr_str)] = _ip.toString();
+}
+
+static size_t write_config_json(Print &out, ModuleType _mdl)
+{
+  // общие параметры модуля и каждое реле сериализуются отдельными небольшими документами,
+  // поэтому расход памяти не зависит ни от количества реле, ни от длины их описаний;
+  // возвращает количество выведенных байт, 0 - данные не поместились в документ
+  String chunk;
+  {
+    StaticJsonDocument<RELAY_DATA_SIZE> doc;
+    doc[FPSTR(sr_module_str)] = ctx->module_description.c_str();
+    doc[FPSTR(sr_wificonf_str)] = ctx->wifi_config_page.c_str();
+    doc[FPSTR(sr_relayconf_str)] = ctx->relay_config_page.c_str();
+    if (_mdl == mtRelay)
+    {
+      doc[FPSTR(sr_for_str)] = FPSTR(sr_relay_str);
+      doc[FPSTR(sr_save_state_str)] = (byte)ctx->save_state_of_relay;
+    }
+    else
+    {
+      doc[FPSTR(sr_for_str)] = FPSTR(sr_switch_str);
+    }
+    if (doc.overflowed())
+    {
+      return (0);
+    }
+    serializeJson(doc, chunk);
+  }
+  // закрывающую скобку заменяем началом массива реле
+  chunk.remove(chunk.length() - 1);
+  chunk += F(",\"");
+  chunk += FPSTR(sr_relays_str);
+  chunk += F("\":[");
+  size_t result = out.print(chunk);
+
+  int16_t count = (_mdl == mtRelay) ? ctx->relayCount : ctx->switchCount;
+  for (int16_t i = 0; i < count; i++)
+  {
+    StaticJsonDocument<RELAY_DATA_SIZE> doc;
+    JsonObject rel = doc.to<JsonObject>();
+    if (_mdl == mtRelay)
+    {
+      get_relay_data_json(rel,
+                          ctx->relayArray[i].relayName,
+                          ctx->relayArray[i].relayDescription,
+                          (byte)get_relay_state(i));
+    }
+    else
+    {
+      get_relay_data_json(rel,
+                          ctx->switchArray[i].relayName,
+                          ctx->switchArray[i].relayDescription,
+                          ctx->switchArray[i].relayAddress);
+    }
+    if (doc.overflowed())
+    {
+      return (0);
+    }
+
+    if (i > 0)
+    {
+      result += out.print(',');
+    }
+    result += serializeJson(doc, out);
+  }
+  result += out.print(F("]}"));
+
+  return (result);
+}
+
+static void send_relays_json(ModuleType _mdl, bool _config, uint32_t _since)
+{
+  // ответ передается по частям (chunked): сначала общие параметры, затем по одному реле,
+  // поэтому расход памяти не зависит ни от количества реле, ни от длины их описаний
+  ctx->http_server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  ctx->http_server->send(200, FPSTR(TEXT_JSON), "");
+
+  String chunk;
+  chunk.reserve(RELAY_DATA_SIZE);
+  {
+    StaticJsonDocument<RELAY_DATA_SIZE> doc;
+    if (_config)
+    {
+      doc[FPSTR(sr_module_str)] = ctx->module_description.c_str();
+      doc[FPSTR(sr_wificonf_str)] = ctx->wifi_config_page.c_str();
+      doc[FPSTR(sr_relayconf_str)] = ctx->relay_config_page.c_str();
+      if (_mdl == mtRelay)
+      {
+        doc[FPSTR(sr_for_str)] = FPSTR(sr_relay_str);
+        doc[FPSTR(sr_save_state_str)] = (byte)ctx->save_state_of_relay;
+      }
+      else
+      {
+        doc[FPSTR(sr_for_str)] = FPSTR(sr_switch_str);
+      }
+    }
+    else
+    {
+      // в запросе состояния - идентификатор запуска и текущая версия, с которой клиент может
+      // запросить следующие изменения
+      doc[FPSTR(sr_boot_str)] = ctx->boot_id;
+      doc[FPSTR(sr_version_str)] = ctx->state_version;
+    }
+    serializeJson(doc, chunk);
+  }
+  // закрывающую скобку заменяем началом массива реле
+  chunk.remove(chunk.length() - 1);
+  if (chunk.length() > 1)
+  {
+    chunk += ',';
+  }
+  chunk += '"';
+  chunk += FPSTR(sr_relays_str);
+  chunk += F("\":[");
+  ctx->http_server->sendContent(chunk);
+
+  int16_t count = (_mdl == mtRelay) ? ctx->relayCount : ctx->switchCount;
+  bool first = true;
+  for (int16_t i = 0; i < count; i++)
+  {
+    // реле, не менявшие состояние после версии _since, пропускаем
+    if (_mdl == mtRelay && _since > 0 && ctx->relayArray[i].relayVersion <= _since)
+    {
+      continue;
+    }
+
+    StaticJsonDocument<RELAY_DATA_SIZE> doc;
+    JsonObject rel = doc.to<JsonObject>();
+    if (_mdl == mtRelay)
+    {
+      get_relay_data_json(rel,
+                          ctx->relayArray[i].relayName,
+                          ctx->relayArray[i].relayDescription,
+                          (byte)get_relay_state(i));
+      // в выборке изменений позиция в массиве не совпадает с индексом реле
+      if (_since > 0)
+      {
+        rel[FPSTR(sr_relay_str)] = i;
+      }
+    }
+    else
+    {
+      get_relay_data_json(rel,
+                          ctx->switchArray[i].relayName,
+                          ctx->switchArray[i].relayDescription,
+                          ctx->switchArray[i].relayAddress);
+    }
+
+    chunk = (first) ? "" : ",";
+    first = false;
+    srStringPrint out(chunk);
+    serializeJson(doc, out);
+    ctx->http_server->sendContent(chunk);
+  }
+
+  ctx->http_server->sendContent(F("]}"));
+  // пустая часть завершает ответ
+  ctx->http_server->sendContent("");
+}
+
+static void handleGetRelayConfig()
+{
+  send_relays_json(mtRelay, true, 0);
+}
+
+static void handleGetSwitchConfig()
+{
+  send_relays_json(mtSwitch, true, 0);
+}
+
+static void getStringValue(String &_var, String _val)
+{
+  _var = (_val != "null") ? _val : "";
+}
+
+static srContext *get_web_module(const char *_for)
+{
+  // на одном Web-сервере могут работать модули реле и выключателя, а общие адреса обслуживает
+  // обработчик модуля, зарегистрировавшего их первым; поэтому запрос передается тому из
+  // запущенных модулей этого сервера, тип которого указан в "for"
+  ModuleType mdt;
+  if (strcmp_P(_for, sr_relay_str) == 0)
+  {
+    mdt = mtRelay;
+  }
+  else if (strcmp_P(_for, sr_switch_str) == 0)
+  {
+    mdt = mtSwitch;
+  }
+  else
+  {
+    return (NULL);
+  }
+
+  if (ctx->type == mdt)
+  {
+    return (ctx);
+  }
+  for (uint8_t m = 0; m < SR_MAX_UDP_MODULES; m++)
+  {
+    if (udp_modules[m] != NULL &&
+        udp_modules[m]->type == mdt &&
+        udp_modules[m]->http_server == ctx->http_server)
+    {
+      return (udp_modules[m]);
+    }
+  }
+
+  return (NULL);
+}
+
+static void handleGetModuleConfig()
+{
+  // без аргумента "for" отдаются настройки модуля, зарегистрировавшего обработчик
+  srContext *mdl = ctx;
+  if (ctx->http_server->hasArg(FPSTR(sr_for_str)))
+  {
+    mdl = get_web_module(ctx->http_server->arg(FPSTR(sr_for_str)).c_str());
+  }
+  if (mdl == NULL)
+  {
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), F("Unknown module type"));
+    return;
+  }
+
+  ctx = mdl;
+  send_relays_json(ctx->type, true, 0);
+}
+
+static void handleSetConfig()
+{
+  if (ctx->http_server->hasArg("plain") == false)
+  {
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), F("Body not received"));
+    SR_PRINTLN(F("Failed to save configuration data, no data"));
+    return;
+  }
+
+  String json = ctx->http_server->arg("plain");
+
+  // документ постоянного размера: сначала общие параметры, затем реле по одному
+  DynamicJsonDocument doc(CONFIG_SIZE);
+  srStringStream params(json);
+  DeserializationError error = read_config_params(doc, params);
+  if (error)
+  {
+    SR_PRINTLN(F("Failed to save configuration data, invalid json data"));
+    SR_PRINTLN(error.f_str());
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), F("Invalid json data"));
+    return;
+  }
+
+  srContext *mdl = get_web_module(doc[FPSTR(sr_for_str)] | "");
+  if (mdl == NULL)
+  {
+    SR_PRINTLN(F("Failed to save configuration data, unknown module type"));
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), F("Unknown module type"));
+    return;
+  }
+
+  // файл собирается заново, чтобы в него попало и текущее состояние реле
+  ctx = mdl;
+  srStringStream relays(json);
+  load_setting(ctx->type, doc, relays);
+  save_config_file(ctx->type);
+  ctx->http_server->send(200, FPSTR(TEXT_HTML), F("<META http-equiv='refresh' content='1;URL=/'><p align='center'>Save settings...</p>"));
+}
+
+static void handleRelaySwitch()
+{
+  if (ctx->http_server->hasArg("plain"))
+  {
+    String json = ctx->http_server->arg("plain");
+
+    int16_t index = get_argument(json, FPSTR(sr_relay_str)).toInt();
+
+    switch_local_relay(index);
+    ctx->http_server->send(200, FPSTR(TEXT_HTML), get_state_str(get_relay_state(index)));
+  }
+  else
+  {
+    ctx->http_server->send(200, FPSTR(TEXT_HTML), FPSTR(sr_off_str));
+  }
 }
 
-static void set_all_remote_relay_state(bool state)
+static void handleRemoteRelaySwitch()
 {
-  if (WiFi.isConnected())
+  if (ctx->http_server->hasArg("plain"))
   {
-    IPAddress broadcastAddress = get_broadcast_address();
+    String json = ctx->http_server->arg("plain");
 
-    String st = (state) ? sr_set_on_str : sr_set_off_str;
-    String s = get_json_string_to_send(sr_any_str, st);
-    SR_PRINT(F("Sending a request to set the state for all remote relays: "));
-    SR_PRINTLN(st);
-    SR_PRINT(F("Broadcast address: "));
-    SR_PRINTLN(broadcastAddress);
-    send_udp_packet(broadcastAddress, s.c_str(), s.length());
+    int16_t index = get_argument(json, FPSTR(sr_relay_str)).toInt();
+
+    switch_remote_relay(index);
+    ctx->http_server->send(200, FPSTR(TEXT_HTML), FPSTR(sr_ok_str));
   }
   else
   {
-    bzr.startBuzzer(3);
-    SR_PRINTLN(F("Failed to send command to remote relay, connection lost"));
+    ctx->http_server->send(200, FPSTR(TEXT_HTML), FPSTR(sr_no_str));
   }
 }
 
-static void send_command_for_relay(int8_t index, const String &command)
+static bool get_bulk_states(uint8_t *mask, uint8_t *states, int16_t count)
 {
-  if (WiFi.isConnected())
+  if (ctx->http_server->hasArg("plain") == false)
   {
-    if ((index >= 0) &&
-        (index < switchCount) &&
-        (switchArray[index].relayName != emptyString))
+    return (false);
+  }
+
+  String json = ctx->http_server->arg("plain");
+  // тело - {"relays":[{"relay":0,"state":"on"},...]} или просто массив таких записей;
+  // записи разбираются по одной, поэтому размер документа не зависит от их количества
+  srStringStream in(json);
+  if (!find_relays_array(in))
+  {
+    SR_PRINTLN(F("Failed to set relay states, invalid json data"));
+    return (false);
+  }
+
+  StaticJsonDocument<RELAY_DATA_SIZE> doc;
+  int8_t item;
+  for (bool first = true; (item = read_relay_item(doc, in, first)) > 0; first = false)
+  {
+    JsonObject rel = doc.as<JsonObject>();
+    int16_t index = rel[FPSTR(sr_relay_str)] | -1;
+    if ((index < 0) || (index >= count))
+    {
+      continue;
+    }
+
+    // состояние задается явно: "on"/"off", true/false или 1/0
+    JsonVariant st = rel[FPSTR(sr_state_str)];
+    bool state;
+    if (st.is<const char *>())
     {
-      if (switchArray[index].relayFound)
+      const char *str = st.as<const char *>();
+      if (strcmp_P(str, sr_on_str) == 0)
       {
-        String s = get_json_string_to_send(switchArray[index].relayName,
-                                           command);
-        SR_PRINTLN(F("Sending a command to remote relay"));
-        SR_PRINT(F("Relay name: "));
-        SR_PRINT(switchArray[index].relayName);
-        SR_PRINT(F("; IP: "));
-        SR_PRINT(switchArray[index].relayAddress);
-        SR_PRINT(F("; command: "));
-        SR_PRINTLN(command);
-        switchArray[index].relayFound = false;
-        send_udp_packet(switchArray[index].relayAddress, s.c_str(), s.length());
+        state = true;
+      }
+      else if (strcmp_P(str, sr_off_str) == 0)
+      {
+        state = false;
       }
       else
       {
-        bzr.startBuzzer(2);
-        SR_PRINT(F("Relay "));
-        SR_PRINT(switchArray[index].relayName);
-        SR_PRINTLN(F(" not found!"));
-        find_remote_relays();
+        continue;
       }
     }
+    else if (st.is<bool>() || st.is<int>())
+    {
+      state = st.as<bool>();
+    }
+    else
+    {
+      continue;
+    }
+
+    mask[index >> 3] |= 1 << (index & 7);
+    if (state)
+    {
+      states[index >> 3] |= 1 << (index & 7);
+    }
+    else
+    {
+      states[index >> 3] &= ~(1 << (index & 7));
+    }
   }
-  else
+  if (item < 0)
   {
-    bzr.startBuzzer(3);
-    SR_PRINTLN(F("Failed to send command to remote relay, connection lost"));
+    SR_PRINTLN(F("Failed to set relay states, invalid json data"));
   }
+
+  return (item == 0);
 }
 
-static void find_remote_relays()
+static void handleRelaySetStates()
 {
-  for (uint8_t i = 0; i < relayCount; i++)
+  uint8_t mask[SR_MASK_SIZE] = {0};
+  uint8_t states[SR_MASK_SIZE] = {0};
+  if (!get_bulk_states(mask, states, ctx->relayCount))
   {
-    switchArray[i].relayFound = false;
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), FPSTR(sr_no_str));
+    return;
   }
 
-  IPAddress broadcastAddress = get_broadcast_address();
-
-  String s = get_json_string_to_send(sr_any_str, sr_respond_str);
-  SR_PRINTLN(F("Sending a request to check IP addresses of relays"));
-  SR_PRINT(F("Broadcast address: "));
-  SR_PRINTLN(broadcastAddress);
-  send_udp_packet(broadcastAddress, s.c_str(), s.length());
-}
-
-// ==== реакции сервера ==============================
-static void handleGetConfigPage(String arg, String page)
-{
-  String c_lab = F("<p id='label'>");
-  page.replace(c_lab, c_lab + arg);
-  http_server->send(200, FPSTR(TEXT_HTML), page);
-}
-
-static void handleGetRelayConfigPage()
-{
-  handleGetConfigPage(FPSTR(RELAY_GET_CONFIG), FPSTR(config_page));
-}
-
-static void handleGetSwitchConfigPage()
-{
-  handleGetConfigPage(FPSTR(SWITCH_GET_CONFIG), FPSTR(config_page));
-}
-
-static void handleGetRelayIndexPage()
-{
-  handleGetConfigPage(FPSTR(RELAY_GET_CONFIG), FPSTR(index_page));
-}
-
-static void handleGetSwitchIndexPage()
-{
-  handleGetConfigPage(FPSTR(SWITCH_GET_CONFIG), FPSTR(index_page));
-}
+  // все изменения применяются за один проход и переносятся на выходы одной записью; сохранение
+  // состояния, уведомления подписчиков и Web-страниц уходят потом одним пакетом из tick()
+  ctx->output_batch = true;
+  for (int16_t i = 0; i < ctx->relayCount; i++)
+  {
+    if (mask[i >> 3] & (1 << (i & 7)))
+    {
+      set_local_relay_state(i, states[i >> 3] & (1 << (i & 7)));
+    }
+  }
+  ctx->output_batch = false;
+  commit_relay_outputs();
 
-static void handleGetConfig(String _msg)
-{
-  http_server->send(200, FPSTR(TEXT_JSON), _msg);
+  send_relays_json(mtRelay, false, 0);
 }
 
-static void get_relay_data_json(JsonObject &rel,
-                                const String &_name,
-                                const String &_descr,
-                                const int8_t _last)
+static void handleRemoteSetStates()
 {
-  if (_last >= 0)
+  uint8_t mask[SR_MASK_SIZE] = {0};
+  uint8_t states[SR_MASK_SIZE] = {0};
+  if (!get_bulk_states(mask, states, ctx->switchCount))
   {
-    rel[sr_last_state_str] = _last;
+    ctx->http_server->send(400, FPSTR(TEXT_PLAIN), FPSTR(sr_no_str));
+    return;
   }
-  rel[sr_name_str] = _name;
-  rel[sr_descr_str] = _descr;
-}
 
-static void get_relay_data_json(JsonObject &rel,
-                                const String &_name,
-                                const String &_descr,
-                                const IPAddress _ip)
-{
-  rel[sr_name_str] = _name;
-  rel[sr_descr_str] = _descr;
-  rel[sr_ip_addr_str] = _ip.toString();
+  // реле одного модуля получают команды одним пакетом
+  send_multi_command(mask, states);
+  ctx->http_server->send(200, FPSTR(TEXT_HTML), FPSTR(sr_ok_str));
 }
 
-static void get_config_json_doc(DynamicJsonDocument &doc, ModuleType _mdl)
+static void handleRelayEvents()
 {
-  doc[sr_module_str] = module_description;
-  JsonArray relays = doc.createNestedArray(sr_relays_str);
-  doc[sr_wificonf_str] = wifi_config_page;
-  doc[sr_relayconf_str] = relay_config_page;
-
-  switch (_mdl)
+  // ищем свободное место, заодно освобождая места отключившихся клиентов
+  int8_t n = -1;
+  for (uint8_t i = 0; i < SR_MAX_EVENT_CLIENTS; i++)
   {
-  case mtRelay:
-    doc[sr_for_str] = sr_relay_str;
-    doc[sr_save_state_str] = (byte)save_state_of_relay;
-    
-    for (int8_t i = 0; i < relayCount; i++)
+    if (ctx->event_clients[i] && !ctx->event_clients[i].connected())
     {
-      JsonObject rel = relays.createNestedObject();
-      get_relay_data_json(rel,
-                          relayArray[i].relayName,
-                          relayArray[i].relayDescription,
-                          (byte)relayArray[i].relayLastState);
+      ctx->event_clients[i].stop();
+      ctx->event_clients[i] = WiFiClient();
     }
-    break;
-  case mtSwitch:
-    doc[sr_for_str] = sr_switch_str;
+    if (!ctx->event_clients[i] && n < 0)
+    {
+      n = i;
+    }
+  }
+  if (n < 0)
+  {
+    // страница в этом случае получает состояние реле опросом /relay_getstate
+    ctx->http_server->send(503, FPSTR(TEXT_PLAIN), F("Too many event clients"));
+    return;
+  }
 
-    for (int8_t i = 0; i < switchCount; i++)
+  // соединение остается открытым, события дописываются в него из tick()
+  ctx->event_clients[n] = ctx->http_server->client();
+  ctx->event_clients[n].setNoDelay(true);
+#if defined(ARDUINO_ARCH_ESP8266)
+  // состояние всех реле может не поместиться в буфер передачи, поэтому при подключении оно
+  // отправляется с ожиданием, но ограниченным по времени
+  ctx->event_clients[n].setTimeout(SR_EVENT_WRITE_TIMEOUT);
+#endif
+  ctx->http_server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+  ctx->http_server->sendContent_P(PSTR("HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: text/event-stream\r\n"
+                                       "Cache-Control: no-cache\r\n"
+                                       "Connection: keep-alive\r\n\r\n"));
+
+  // первое событие - состояние всех реле
+  String data = F("data: {");
+  for (int16_t i = 0; i < ctx->relayCount; i++)
+  {
+    if (i > 0)
     {
-      JsonObject rel = relays.createNestedObject();
-      get_relay_data_json(rel,
-                          switchArray[i].relayName,
-                          switchArray[i].relayDescription,
-                          switchArray[i].relayAddress);
+      data += ',';
     }
-    break;
+    data += '"';
+    data += i;
+    data += F("\":");
+    data += (get_relay_state(i)) ? '1' : '0';
+  }
+  data += F("}\n\n");
+  if (ctx->event_clients[n].write((const uint8_t *)data.c_str(), data.length()) != data.length())
+  {
+    ctx->event_clients[n].stop();
+    ctx->event_clients[n] = WiFiClient();
   }
 }
 
-static String get_config_json_string(ModuleType _mdl)
+static void handleGetRelayState()
 {
-  DynamicJsonDocument doc(CONFIG_SIZE);
-
-  get_config_json_doc(doc, _mdl);
+  // ?since=N&boot=B - только реле, изменившие состояние после версии N; если B не совпадает
+  // с идентификатором текущего запуска (модуль перезагружался) или не передан, отдаются все реле
+  uint32_t since = 0;
+  if (ctx->http_server->hasArg(FPSTR(sr_since_str)) &&
+      strtoul(ctx->http_server->arg(FPSTR(sr_boot_str)).c_str(), NULL, 10) == ctx->boot_id)
+  {
+    since = strtoul(ctx->http_server->arg(FPSTR(sr_since_str)).c_str(), NULL, 10);
+    if (since > ctx->state_version)
+    {
+      since = 0;
+    }
+  }
 
-  String _res = "";
-  serializeJson(doc, _res);
-  return (_res);
+  send_relays_json(mtRelay, false, since);
 }
 
-static void handleGetRelayConfig()
+static DeserializationError read_config_params(JsonDocument &doc, Stream &in)
 {
-  handleGetConfig(get_config_json_string(mtRelay));
-}
+  // массив реле пропускается, его элементы читаются по одному в load_setting()
+  StaticJsonDocument<96> filter;
+  filter[FPSTR(sr_module_str)] = true;
+  filter[FPSTR(sr_for_str)] = true;
+  filter[FPSTR(sr_save_state_str)] = true;
 
-static void handleGetSwitchConfig()
-{
-  handleGetConfig(get_config_json_string(mtSwitch));
+  return (deserializeJson(doc, in, DeserializationOption::Filter(filter)));
 }
 
-static void getStringValue(String &_var, String _val)
+static int skip_spaces(Stream &in)
 {
-  _var = (_val != "null") ? _val : "";
+  while (in.peek() == ' ' || in.peek() == '\t' || in.peek() == '\r' || in.peek() == '\n')
+  {
+    in.read();
+  }
+
+  return (in.peek());
 }
 
-static void handleSetConfig()
+static bool skip_json_string(Stream &in, PGM_P _match)
 {
-  if (http_server->hasArg("plain") == false)
+  // строка вместе с кавычками; true - ее содержимое совпало с _match (NULL - не сравнивать)
+  bool equal = (_match != NULL);
+  size_t i = 0;
+  in.read();
+  for (int c = in.read(); c != '"'; c = in.read())
   {
-    http_server->send(200, FPSTR(TEXT_PLAIN), F("Body not received"));
-    SR_PRINTLN(F("Failed to save configuration data, no data"));
-    return;
+    if (c < 0)
+    {
+      return (false);
+    }
+    if (c == '\\')
+    {
+      // экранированный символ пропускается, с такими ключами строка не сравнивается
+      in.read();
+      equal = false;
+    }
+    else if (equal)
+    {
+      equal = (pgm_read_byte(_match + i++) == c);
+    }
   }
 
-  String json = http_server->arg("plain");
-
-  DynamicJsonDocument doc(CONFIG_SIZE);
+  return (equal && pgm_read_byte(_match + i) == 0);
+}
 
-  DeserializationError error = deserializeJson(doc, json);
-  if (error)
-  {
-    SR_PRINTLN(F("Failed to save configuration data, invalid json data"));
-    SR_PRINTLN(error.f_str());
-  }
-  else
+static bool skip_json_value(Stream &in)
+{
+  // значение любого типа до запятой или конца объекта; вложенные объекты и массивы
+  // пропускаются целиком, скобки внутри строк не учитываются
+  uint16_t depth = 0;
+  for (int c = skip_spaces(in); c >= 0; c = skip_spaces(in))
   {
-    if (doc[sr_for_str].as<String>() == sr_relay_str)
+    if (depth == 0 && (c == ',' || c == '}' || c == ']'))
+    {
+      return (true);
+    }
+    if (c == '"')
+    {
+      skip_json_string(in, NULL);
+      continue;
+    }
+    if (c == '{' || c == '[')
     {
-      load_setting(mtRelay, doc);
-      save_config_file(mtRelay, doc);
+      depth++;
     }
-    else if (doc[sr_for_str].as<String>() == sr_switch_str)
+    else if (c == '}' || c == ']')
     {
-      load_setting(mtSwitch, doc);
-      save_config_file(mtSwitch, doc);
+      depth--;
     }
-    http_server->send(200, FPSTR(TEXT_HTML), F("<META http-equiv='refresh' content='1;URL=/'><p align='center'>Save settings...</p>"));
+    in.read();
   }
+
+  return (false);
 }
 
-static void handleRelaySwitch()
+static bool find_relays_array(Stream &in)
 {
-  if (http_server->hasArg("plain"))
+  // данные могут быть самим массивом реле или объектом с полем "relays"; поле ищется только
+  // среди ключей верхнего уровня, поэтому строка "relays" в значениях других полей не мешает
+  int c = skip_spaces(in);
+  if (c == '{')
   {
-    String json = http_server->arg("plain");
-
-    int8_t index = get_argument(json, sr_relay_str).toInt();
-
-    switch_local_relay(index);
-    http_server->send(200, FPSTR(TEXT_HTML), get_relay_state(index));
+    in.read();
+    for (c = skip_spaces(in); c == '"'; c = skip_spaces(in))
+    {
+      bool found = skip_json_string(in, sr_relays_str);
+      if (skip_spaces(in) != ':')
+      {
+        return (false);
+      }
+      in.read();
+      if (found)
+      {
+        c = skip_spaces(in);
+        break;
+      }
+      if (!skip_json_value(in) || skip_spaces(in) != ',')
+      {
+        return (false);
+      }
+      in.read();
+    }
   }
-  else
+  if (c != '[')
   {
-    http_server->send(200, FPSTR(TEXT_HTML), sr_off_str);
+    return (false);
   }
+  in.read();
+
+  return (true);
 }
 
-static void handleRemoteRelaySwitch()
+static int8_t read_relay_item(JsonDocument &doc, Stream &in, bool _first)
 {
-  if (http_server->hasArg("plain"))
+  // 1 - в doc прочитан очередной элемент массива, 0 - массив закончился, -1 - ошибка данных
+  int c = skip_spaces(in);
+  if (c == ']')
   {
-    String json = http_server->arg("plain");
-
-    int8_t index = get_argument(json, sr_relay_str).toInt();
-
-    switch_remote_relay(index);
-    http_server->send(200, FPSTR(TEXT_HTML), sr_ok_str);
+    in.read();
+    return (0);
   }
-  else
+  if (!_first)
   {
-    http_server->send(200, FPSTR(TEXT_HTML), sr_no_str);
+    // элементы разделяются запятой
+    in.read();
+    if (c != ',')
+    {
+      return (-1);
+    }
+    c = skip_spaces(in);
+  }
+  if (c != '{')
+  {
+    return (-1);
   }
-}
-
-static void handleGetRelayState()
-{
-  String _res = "";
 
-  DynamicJsonDocument doc(CONFIG_SIZE);
-  JsonArray relays = doc.createNestedArray(sr_relays_str);
-  for (int8_t i = 0; i < relayCount; i++)
+  DeserializationError error = deserializeJson(doc, in);
+  if (error)
   {
-    JsonObject rel = relays.createNestedObject();
-    bool state = get_relay_state(i) == sr_on_str;
-    get_relay_data_json(rel,
-                        relayArray[i].relayName,
-                        relayArray[i].relayDescription,
-                        (byte)state);
+    SR_PRINTLN(error.f_str());
+    return (-1);
   }
-  serializeJson(doc, _res);
 
-  http_server->send(200, FPSTR(TEXT_JSON), _res);
+  return (1);
 }
 
-static bool load_setting(ModuleType _mdt, DynamicJsonDocument &doc)
+static bool load_setting(ModuleType _mdt, JsonDocument &doc, Stream &in)
 {
-  getStringValue(module_description, doc[sr_module_str].as<String>());
-  int8_t x = doc[sr_relays_str].size();
-  switch (_mdt)
+  // doc - общие параметры модуля, прочитанные read_config_params(); in - те же данные с начала,
+  // из них по одному читаются элементы массива реле, doc для этого используется повторно
+  getStringValue(ctx->module_description, doc[FPSTR(sr_module_str)].as<String>());
+  if (_mdt == mtRelay)
   {
-  case mtRelay:
-    save_state_of_relay = doc[sr_save_state_str].as<bool>();
-    for (int8_t i = 0; i < x && i < relayCount; i++)
-    {
-      getStringValue(relayArray[i].relayName,
-                     doc[sr_relays_str][i][sr_name_str].as<String>());
-      getStringValue(relayArray[i].relayDescription,
-                     doc[sr_relays_str][i][sr_descr_str].as<String>());
-      relayArray[i].relayLastState = doc[sr_relays_str][i][sr_last_state_str].as<bool>();
-    }
-    break;
-  case mtSwitch:
-    for (int8_t i = 0; i < x && i < switchCount; i++)
+    ctx->save_state_of_relay = doc[FPSTR(sr_save_state_str)].as<bool>();
+  }
+  else if (_mdt != mtSwitch)
+  {
+    return (false);
+  }
+
+  // без массива реле данные считаются неверными
+  bool found = find_relays_array(in);
+  int8_t item = 0;
+  if (found)
+  {
+    int16_t count = (_mdt == mtRelay) ? ctx->relayCount : ctx->switchCount;
+    int16_t i = 0;
+    for (bool first = true; (item = read_relay_item(doc, in, first)) > 0 && i < count; first = false, i++)
     {
-      getStringValue(switchArray[i].relayName,
-                     doc[sr_relays_str][i][sr_name_str].as<String>());
-      if (doc[sr_relays_str][i][sr_name_str].as<String>() == "")
+      JsonObject rel = doc.as<JsonObject>();
+      if (_mdt == mtRelay)
       {
-        doc[sr_relays_str][i][sr_descr_str] = "";
+        getStringValue(ctx->relayArray[i].relayName, rel[FPSTR(sr_name_str)].as<String>());
+        getStringValue(ctx->relayArray[i].relayDescription, rel[FPSTR(sr_descr_str)].as<String>());
+        // страница настройки состояние реле не передает, в этом случае оставляем текущее;
+        // состояние из файла настроек - оно же последнее сохраненное; теневой регистр при
+        // загрузке еще пуст, поэтому сохраненное состояние берется не из него
+        JsonVariant last = rel[FPSTR(sr_last_state_str)];
+        if (!last.isNull())
+        {
+          ctx->relayArray[i].relayLastState = last.as<bool>();
+          ctx->relayArray[i].relaySavedState = ctx->relayArray[i].relayLastState;
+        }
+      }
+      else
+      {
+        getStringValue(ctx->switchArray[i].relayName, rel[FPSTR(sr_name_str)].as<String>());
+        if (ctx->switchArray[i].relayName == "")
+        {
+          ctx->switchArray[i].relayDescription = "";
+        }
+        else
+        {
+          getStringValue(ctx->switchArray[i].relayDescription, rel[FPSTR(sr_descr_str)].as<String>());
+        }
       }
-
-      getStringValue(switchArray[i].relayDescription,
-                     doc[sr_relays_str][i][sr_descr_str].as<String>());
     }
-    break;
-  default:
-    return (false);
-    break;
   }
-  return (true);
+  build_name_index(_mdt);
+
+  return (found && item >= 0);
 }
 
 static String get_config_file_name(ModuleType _mdt)
@@ -1300,9 +4153,9 @@ static String get_config_file_name(ModuleType _mdt)
   switch (_mdt)
   {
   case mtRelay:
-    return (relayFileConfigName);
+    return (ctx->relayFileConfigName);
   case mtSwitch:
-    return (switchFileConfigName);
+    return (ctx->switchFileConfigName);
   default:
     return ("");
   }
@@ -1310,30 +4163,40 @@ static String get_config_file_name(ModuleType _mdt)
 
 static bool save_config_file(ModuleType _mdt)
 {
-  DynamicJsonDocument doc(CONFIG_SIZE);
-  get_config_json_doc(doc, _mdt);
-  return (save_config_file(_mdt, doc));
-}
+  if (!ctx->file_system)
+  {
+    return (false);
+  }
 
-static bool save_config_file(ModuleType _mdt, DynamicJsonDocument &doc)
-{
-  if (!file_system)
+  // считаем контрольную сумму до записи, чтобы заголовок шел перед данными; неполные данные
+  // получили бы корректный заголовок и стали бы последней версией настроек, поэтому при
+  // нехватке памяти для данных реле файл не пишется
+  srCrcPrint crc;
+  if (write_config_json(crc, _mdt) == 0)
   {
+    SR_PRINTLN(F("Failed to save settings, not enough memory for configuration data"));
     return (false);
   }
 
-  String fileName = get_config_file_name(_mdt);
+  // если файл настроек еще не читался, сначала нужно узнать, в каком слоте последняя версия
+  if (ctx->config_slot[_mdt] < 0)
+  {
+    size_t offset;
+    find_config_slot(_mdt, offset);
+  }
+
+  // новая версия пишется в свободный слот, слот с текущей версией не трогаем до конца записи
+  uint8_t slot = (ctx->config_slot[_mdt] == 0) ? 1 : 0;
+  String fileName = get_config_slot_name(_mdt, slot);
 
   SR_PRINT(F("Save settings to file "));
   SR_PRINTLN(fileName);
 
-  File configFile;
-
-  // удалить существующий файл, иначе конфигурация будет добавлена ​​к файлу
-  file_system->remove(fileName);
+  char header[CONFIG_HEADER_SIZE];
+  uint32_t seq = ctx->config_seq[_mdt] + 1;
+  size_t header_len = sr_get_config_header(header, seq, crc.getCrc(), crc.len);
 
-  // Открыть файл для записи
-  configFile = file_system->open(fileName, "w");
+  File configFile = ctx->file_system->open(fileName, "w");
 
   if (!configFile)
   {
@@ -1343,10 +4206,20 @@ static bool save_config_file(ModuleType _mdt, DynamicJsonDocument &doc)
   }
 
   // сериализовать JSON-файл
-  bool result = serializeJson(doc, configFile);
+  bool result = configFile.write((const uint8_t *)header, header_len) == header_len &&
+                write_config_json(configFile, _mdt) == crc.len;
+  configFile.close();
   if (result)
   {
     SR_PRINTLN(F("OK"));
+    ctx->config_seq[_mdt] = seq;
+    ctx->config_slot[_mdt] = slot;
+    if (_mdt == mtRelay)
+    {
+      // состояние реле теперь полностью в файле настроек, журнал больше не нужен
+      mark_relay_state_saved();
+      clear_relay_journal();
+    }
   }
   else
   {
@@ -1354,43 +4227,96 @@ static bool save_config_file(ModuleType _mdt, DynamicJsonDocument &doc)
     SR_PRINTLN(fileName);
   }
 
+  return (result);
+}
+
+static String get_config_slot_name(ModuleType _mdt, uint8_t _slot)
+{
+  // слот A - файл с исходным именем, поэтому старый файл настроек без заголовка тоже будет прочитан
+  String result = get_config_file_name(_mdt);
+  if (_slot > 0)
+  {
+    result += ".b";
+  }
+
+  return (result);
+}
+
+static bool check_config_slot(const String &fileName, uint32_t &_seq, size_t &_offset)
+{
+  if (!ctx->file_system->exists(fileName))
+  {
+    return (false);
+  }
+  File configFile = ctx->file_system->open(fileName, "r");
+  if (!configFile)
+  {
+    return (false);
+  }
+
+  bool result = sr_check_config_slot(configFile, configFile.size(), _seq, _offset);
   configFile.close();
+
   return (result);
 }
 
-static bool load_config_file(ModuleType _mdt)
+static int8_t find_config_slot(ModuleType _mdt, size_t &_offset)
 {
-  File configFile;
-  String fileName = get_config_file_name(_mdt);
+  // выбираем корректный слот с самой свежей версией
+  bool valid[CONFIG_SLOT_COUNT];
+  uint32_t seq[CONFIG_SLOT_COUNT];
+  size_t offset[CONFIG_SLOT_COUNT];
+  for (uint8_t i = 0; i < CONFIG_SLOT_COUNT; i++)
+  {
+    valid[i] = check_config_slot(get_config_slot_name(_mdt, i), seq[i], offset[i]);
+  }
 
-  SR_PRINT(F("Load settings from file "));
-  SR_PRINTLN(fileName);
+  int8_t result = sr_select_config_slot(valid, seq);
+  if (result >= 0)
+  {
+    ctx->config_seq[_mdt] = seq[result];
+    _offset = offset[result];
+  }
+  ctx->config_slot[_mdt] = result;
 
-  // находим и открываем для чтения файл конфигурации
-  bool result = file_system &&
-                file_system->exists(fileName) &&
-                (configFile = file_system->open(fileName, "r"));
+  return (result);
+}
 
-  // если файл конфигурации не найден, сохранить настройки по умолчанию
-  if (!result)
+static bool load_config_file(ModuleType _mdt)
+{
+  if (!ctx->file_system)
+  {
+    return (false);
+  }
+
+  File configFile;
+  size_t offset = 0;
+  int8_t slot = find_config_slot(_mdt, offset);
+
+  // если корректный файл конфигурации не найден, сохранить настройки по умолчанию
+  if (slot < 0)
   {
     SR_PRINTLN(F("Config file not found, default config used."));
     save_config_file(_mdt);
-    return (result);
+    return (false);
   }
-  // Проверяем размер файла, будем использовать файл размером меньше 2048 байта
-  size_t size = configFile.size();
-  if (size > CONFIG_SIZE)
+
+  String fileName = get_config_slot_name(_mdt, slot);
+  SR_PRINT(F("Load settings from file "));
+  SR_PRINTLN(fileName);
+
+  configFile = ctx->file_system->open(fileName, "r");
+  bool result = configFile && configFile.seek(offset);
+  if (!result)
   {
-    SR_PRINTLN(F("WiFi configuration file size is too large."));
-    configFile.close();
     return (false);
   }
+  configFile.setTimeout(0);
 
+  // документ постоянного размера: сначала общие параметры, затем реле по одному
   DynamicJsonDocument doc(CONFIG_SIZE);
 
-  DeserializationError error = deserializeJson(doc, configFile);
-  configFile.close();
+  DeserializationError error = read_config_params(doc, configFile);
   if (error)
   {
     SR_PRINT("Data serialization error: ");
@@ -1401,8 +4327,9 @@ static bool load_config_file(ModuleType _mdt)
   else
   // Теперь можно получить значения из doc
   {
-    result = load_setting(_mdt, doc);
+    result = configFile.seek(offset) && load_setting(_mdt, doc, configFile);
   }
+  configFile.close();
   if (result)
   {
     SR_PRINTLN(F("OK"));
@@ -1413,12 +4340,12 @@ static bool load_config_file(ModuleType _mdt)
 
 // ==== shBuzzer class ===============================
 
-void buzzerTick()
+void buzzerTick(shBuzzer *_bzr)
 {
-  bzr.beep();
-  if (bzr.decBipCount() == 0)
+  _bzr->beep();
+  if (_bzr->decBipCount() == 0)
   {
-    bzr.stopBuzzer();
+    _bzr->stopBuzzer();
   }
 }
 
@@ -1443,8 +4370,8 @@ void shBuzzer::startBuzzer(uint8_t _num, uint16_t _freq, uint32_t _dur)
   if (buzzer_state && buzzer_pin >= 0)
   {
     beep_count = _num;
-    buzzer.attach_ms(error_dur * 2, buzzerTick);
-    buzzerTick();
+    buzzer.attach_ms(error_dur * 2, buzzerTick, this);
+    buzzerTick(this);
   }
 }
 
@@ -14,6 +14,7 @@
 #include <FS.h>
 #include <Ticker.h>
 #include "srButtons.h"
+#include "srRelayDrivers.h"
 
 #if defined(ARDUINO_ARCH_ESP32)
 typedef WebServer shWebServer;
@@ -21,55 +22,123 @@ typedef WebServer shWebServer;
 typedef ESP8266WebServer shWebServer;
 #endif
 
+// максимальное количество реле одного модуля, кратно 8; можно переопределить флагом сборки
+#ifndef SR_MAX_RELAY_COUNT
+#define SR_MAX_RELAY_COUNT 512
+#endif
+
+// дескриптор реле - индекс реле в массиве модуля, один раз полученный по имени методом getRelayHandle(); -1 - реле не найдено
+typedef int16_t RelayHandle;
+
+// состояние реле
+enum SrRelayState : int8_t
+{
+  stUnknown = -1, // состояние неизвестно
+  stOff,          // реле выключено
+  stOn            // реле включено
+};
+
 // описание свойств реле
 struct shRelayData
 {
-  String relayName;          // имя реле
-  uint8_t relayPin;          // пин, к которому подключено реле
-  uint8_t relayControlLevel; // управляющий уровень реле (LOW или HIGH)
-  bool relayLastState;       // последнее состояние реле
-  srButton *relayButton;     // локальная кнопка, управляющая реле (располагается на самом модуле и предназначена для ручного управления реле)
-  String relayDescription;   // описание реле
+  String relayName;           // имя реле
+  uint8_t relayPin;           // пин, к которому подключено реле, или номер канала драйвера выходов
+  uint8_t relayControlLevel;  // управляющий уровень реле (LOW или HIGH)
+  bool relayLastState;        // состояние реле, загруженное из файла настроек и восстанавливаемое при старте модуля
+  bool relaySavedState;       // состояние реле, записанное в файл настроек
+  srButton *relayButton;      // локальная кнопка, управляющая реле (располагается на самом модуле и предназначена для ручного управления реле)
+  String relayDescription;    // описание реле
+  uint32_t relayNameHash;     // хэш имени реле для быстрого поиска
+  uint32_t relayVersion;      // версия состояния модуля, при которой реле последний раз изменило состояние
+  srRelayDriver *relayDriver; // драйвер выходов, через который управляется реле; nullptr - пин модуля
   shRelayData() : relayName(""),
                   relayPin(255),
                   relayControlLevel(HIGH),
                   relayButton(nullptr),
                   relayDescription(""),
-                  relayLastState(false) {}
+                  relayLastState(false),
+                  relaySavedState(false),
+                  relayNameHash(0),
+                  relayVersion(0),
+                  relayDriver(nullptr) {}
   shRelayData(String relay_name,
               uint8_t relay_pin,
               uint8_t control_level,
               srButton *relay_button = nullptr,
-              String relay_description = "") : relayName(relay_name),
-                                               relayPin(relay_pin),
-                                               relayControlLevel(control_level),
-                                               relayButton(relay_button),
-                                               relayDescription(relay_description),
-                                               relayLastState(false) {}
+              String relay_description = "",
+              srRelayDriver *relay_driver = nullptr) : relayName(relay_name),
+                                                       relayPin(relay_pin),
+                                                       relayControlLevel(control_level),
+                                                       relayButton(relay_button),
+                                                       relayDescription(relay_description),
+                                                       relayLastState(false),
+                                                       relaySavedState(false),
+                                                       relayNameHash(0),
+                                                       relayVersion(0),
+                                                       relayDriver(relay_driver) {}
 };
 
 // описание свойств выключателя
 struct shSwitchData
 {
   String relayName;        // имя ассоциированного с кнопкой удаленного реле
-  bool relayFound;         // найдено или нет ассоциированное удаленное реле в сети
+  bool relayFound;         // удаленное реле найдено в сети и отвечало не позднее, чем истек срок актуальности
+  uint32_t relayLastSeen;  // время последнего ответа удаленного реле
   IPAddress relayAddress;  // IP адрес удаленного реле
   srButton *relayButton;   // кнопка, управляющая удаленным реле
   String relayDescription; // описание удаленного реле
+  uint8_t relayProto;      // версия бинарного протокола, поддерживаемая удаленным реле; 0 - только JSON
+  uint32_t relayNameHash;  // хэш имени удаленного реле для быстрого поиска
+  uint8_t pendingCommand;  // команда, ожидающая подтверждения; 0 - нет
+  uint16_t pendingSeq;     // порядковый номер неподтвержденной команды
+  uint8_t pendingRetries;  // количество выполненных повторов неподтвержденной команды
+  uint32_t pendingTimer;   // время последней отправки неподтвержденной команды
+  uint16_t commandSuccess; // количество подтвержденных команд
+  uint16_t commandFailed;  // количество команд, оставшихся без подтверждения после всех повторов
+  int8_t relayState;       // последнее известное состояние удаленного реле; -1 - неизвестно
+  int8_t localModule;      // модуль реле этой же прошивки, которому принадлежит реле; -1 - реле на другом устройстве
+  int16_t localIndex;      // индекс реле в этом модуле
   shSwitchData() : relayName(""),
                    relayButton(nullptr),
                    relayDescription(""),
                    relayFound(false),
-                   relayAddress(IPAddress(0, 0, 0, 0)) {}
+                   relayLastSeen(0),
+                   relayAddress(IPAddress(0, 0, 0, 0)),
+                   relayProto(0),
+                   relayNameHash(0),
+                   pendingCommand(0),
+                   pendingSeq(0),
+                   pendingRetries(0),
+                   pendingTimer(0),
+                   commandSuccess(0),
+                   commandFailed(0),
+                   relayState(-1),
+                   localModule(-1),
+                   localIndex(-1) {}
   shSwitchData(String relay_name,
                srButton *relay_button = nullptr) : relayName(relay_name),
                                                    relayButton(relay_button),
                                                    relayDescription(""),
                                                    relayFound(false),
-                                                   relayAddress(IPAddress(0, 0, 0, 0)) {}
+                                                   relayLastSeen(0),
+                                                   relayAddress(IPAddress(0, 0, 0, 0)),
+                                                   relayProto(0),
+                                                   relayNameHash(0),
+                                                   pendingCommand(0),
+                                                   pendingSeq(0),
+                                                   pendingRetries(0),
+                                                   pendingTimer(0),
+                                                   commandSuccess(0),
+                                                   commandFailed(0),
+                                                   relayState(-1),
+                                                   localModule(-1),
+                                                   localIndex(-1) {}
 };
 // TODO: подумать над возможностью задания множественных реле, имеющих одно имя, но физически расположенных на разных модулях; т.е. добавить еще одно свойство и при его активации посылать запрос на переключение не по адресу, а широковещательным пакетом
 
+struct srMessage;
+struct srContext;
+
 // ==== shRelayControl class ===========================
 
 /**
@@ -79,9 +148,16 @@ struct shSwitchData
 class shRelayControl
 {
 private:
-  void respondToRelayCheck(int8_t index);
-  void receiveUdpPacket(int _size);
-  int8_t getRelayIndexByName(String &_res);
+  srContext *context; // данные экземпляра модуля
+  uint8_t udpPacketBudget = 8;
+  uint16_t udpTimeBudget = 10;
+  uint8_t idleDelay = 1;
+
+  void respondToRelayCheck(int16_t index, bool _binary);
+  void receiveUdpPacket(srMessage &msg);
+  int16_t getRelayIndexByName(const String &_name);
+  int16_t getRelayIndexByHash(uint32_t _hash);
+  int16_t getRelayIndexByMessage(const srMessage &msg);
 
 public:
   /**
@@ -93,25 +169,27 @@ public:
   /**
    * @brief инициализация модуля реле
    *
-   * @param _relay_count количество реле
+   * @param _relay_count количество реле; если реле будет добавлено больше, таблица увеличивается в addRelay(); не более SR_MAX_RELAY_COUNT
    */
-  void init(uint8_t _relay_count);
+  void init(uint16_t _relay_count);
 
   /**
    * @brief добавление данных локального реле
    *
    * @param relay_name имя локального реле
-   * @param relay_pin пин, к которому подключено реле
+   * @param relay_pin пин, к которому подключено реле, или номер канала драйвера выходов
    * @param control_level логический уровень, которым управляется реле (HIGH или LOW)
    * @param relay_button локальная кнопка для управления реле или nullptr, если локальной кнопки нет
    * @param relay_description описание реле
+   * @param relay_driver драйвер выходов (сдвиговый регистр, расширитель портов), к которому подключено реле, или nullptr, если реле подключено к пину модуля
    * @return true если реле добавлено успешно, иначе false
    */
   bool addRelay(const String &relay_name,
                 uint8_t relay_pin,
                 uint8_t control_level,
                 srButton *relay_button = nullptr,
-                const String &relay_description = "");
+                const String &relay_description = "",
+                srRelayDriver *relay_driver = nullptr);
 
   /**
    * @brief включение/отключение вывода информации о работе модуля через Serial
@@ -148,11 +226,25 @@ public:
   /**
    * @brief запуск модуля
    *
-   * @param _udp ссылка на экземпляр **WiFiUDP**, который будет использоваться для работы модуля
+   * @param _udp ссылка на экземпляр **WiFiUDP**, который будет использоваться для работы модуля; один экземпляр могут использовать несколько модулей одной прошивки
    * @param _local_port порт для отправки/приема udp-пакетов; должен быть одинаковым для всех связанных модулей
    */
   void startDevice(WiFiUDP *_udp, uint16_t _local_port);
 
+  /**
+   * @brief установка группы multicast, в которую входит модуль; запросы поиска и команды для всех реле, отправленные в группу, получают только модули shSRControl; если адрес не задан (0.0.0.0) или войти в группу не удалось, используется широковещательный адрес; группа должна быть одинаковой для всех связанных модулей
+   *
+   * @param _group адрес группы, 224.0.0.0 - 239.255.255.255
+   */
+  void setMulticastGroup(const IPAddress &_group);
+
+  /**
+   * @brief получение адреса группы multicast
+   *
+   * @return IPAddress
+   */
+  IPAddress getMulticastGroup();
+
   /**
    * @brief подключение Web-интерфейса
    *
@@ -166,6 +258,42 @@ public:
                           const String &_relay_config_page = "/relay_config",
                           const String &_wifi_config_page = "");
 
+  /**
+   * @brief настройка бюджета обработки входящих udp-пакетов за один вызов tick(); пакеты выбираются из очереди, пока она не опустеет или не будет исчерпан бюджет; по умолчанию - 8 пакетов и 10 мс
+   *
+   * @param _max_packets максимальное количество пакетов за один вызов
+   * @param _max_time максимальное время обработки пакетов в милисекундах
+   */
+  void setUdpBudget(uint8_t _max_packets, uint16_t _max_time);
+
+  /**
+   * @brief получение максимального количества пакетов, обрабатываемых за один вызов tick()
+   *
+   * @return uint8_t
+   */
+  uint8_t getUdpPacketBudget();
+
+  /**
+   * @brief получение максимального времени обработки пакетов за один вызов tick() в милисекундах
+   *
+   * @return uint16_t
+   */
+  uint16_t getUdpTimeBudget();
+
+  /**
+   * @brief установка паузы в конце tick(), если никакой работы не было; если работа была или пауза равна 0, вызывается только yield(); по умолчанию - 1 мс
+   *
+   * @param _delay пауза в милисекундах
+   */
+  void setIdleDelay(uint8_t _delay);
+
+  /**
+   * @brief получение размера паузы в конце tick() при отсутствии работы
+   *
+   * @return uint8_t
+   */
+  uint8_t getIdleDelay();
+
   /**
    * @brief обработка событий модуля
    *
@@ -177,14 +305,14 @@ public:
    *
    * @param index индекс реле в массиве
    */
-  void switchRelay(int8_t index);
+  void switchRelay(int16_t index);
 
   /**
    * @brief переключение состояния реле
    *
    * @param _name сетевое имя реле
    */
-  void switchRelay(String _name);
+  void switchRelay(const String &_name);
 
   /**
    * @brief установить состояние реле
@@ -192,7 +320,7 @@ public:
    * @param index индекс реле в массиве
    * @param state новое состояние реле; true - включено, иначе выключено;
    */
-  void setRelayState(int8_t index, bool state);
+  void setRelayState(int16_t index, bool state);
 
   /**
    * @brief установить состояние реле
@@ -200,7 +328,28 @@ public:
    * @param _name сетевое имя реле
    * @param state новое состояние реле; true - включено, иначе выключено;
    */
-  void setRelayState(String _name, bool state);
+  void setRelayState(const String &_name, bool state);
+
+  /**
+   * @brief установка срока аренды подписки на уведомления об изменении состояния реле; подписка продлевается каждой командой подписчика; по умолчанию - 120 секунд
+   *
+   * @param _lease срок аренды в милисекундах
+   */
+  void setSubscriptionLease(uint32_t _lease);
+
+  /**
+   * @brief получение срока аренды подписки на уведомления об изменении состояния реле
+   *
+   * @return uint32_t
+   */
+  uint32_t getSubscriptionLease();
+
+  /**
+   * @brief получение текущей версии состояния модуля; версия увеличивается при каждом изменении состояния любого реле и используется в запросе /relay_getstate?since=N&boot=B вместе с идентификатором запуска модуля
+   *
+   * @return uint32_t
+   */
+  uint32_t getStateVersion();
 
   /**
    * @brief получение информации о текущем состоянии реле (включено/отключено)
@@ -208,7 +357,7 @@ public:
    * @param index  индекс реле в массиве
    * @return String "on" - включено; "off" - отключено
    */
-  String getRelayState(int8_t index);
+  String getRelayState(int16_t index);
 
   /**
    * @brief получение информации о текущем состоянии реле (включено/отключено)
@@ -216,7 +365,23 @@ public:
    * @param _name сетевое имя реле
    * @return String  "on" - включено; "off" - отключено
    */
-  String getRelayState(String _name);
+  String getRelayState(const String &_name);
+
+  /**
+   * @brief получение дескриптора реле по его имени; дескриптор не меняется, пока не изменен список реле модуля, поэтому его достаточно получить один раз и затем использовать вместо имени в методах switchRelay(), setRelayState() и getState(), не создавая строк при каждом вызове
+   *
+   * @param _name сетевое имя реле
+   * @return RelayHandle дескриптор реле; -1 - реле не найдено
+   */
+  RelayHandle getRelayHandle(const char *_name);
+
+  /**
+   * @brief получение текущего состояния реле без создания строк
+   *
+   * @param _relay дескриптор или индекс реле в массиве
+   * @return SrRelayState stOn - включено; stOff - отключено; stUnknown - реле не найдено
+   */
+  SrRelayState getState(RelayHandle _relay);
 
   /**
    * @brief установка описания модуля
@@ -247,13 +412,35 @@ public:
    */
   bool getSaveStateOfRelay();
 
+  /**
+   * @brief установка интервала, в течение которого накапливаются изменения состояния реле перед записью в файл; запись выполняется не чаще одного раза за интервал и только если состояние действительно изменилось; по умолчанию - 3 секунды
+   *
+   * @param _delay интервал в милисекундах
+   */
+  void setSaveStateDelay(uint32_t _delay);
+
+  /**
+   * @brief получение интервала накопления изменений состояния реле перед записью в файл
+   *
+   * @return uint32_t
+   */
+  uint32_t getSaveStateDelay();
+
+  /**
+   * @brief немедленная запись несохраненного состояния реле без ожидания интервала накопления, например, перед перезагрузкой модуля; изменения дописываются в журнал, а если журнал заполнен или предыдущая запись в него не удалась - переносятся в файл настроек
+   *
+   * @return true - состояние записано или записывать нечего
+   * @return false - записать не удалось, запись будет повторена
+   */
+  bool flushRelayState();
+
   /**
    * @brief установка нового сетевого имени реле
    *
    * @param index индекс реле в массиве
    * @param _name новое сетевое имя
    */
-  void setRelayName(int8_t index, String &_name);
+  void setRelayName(int16_t index, String &_name);
 
   /**
    * @brief получение текущего сетевого имени реле
@@ -261,7 +448,7 @@ public:
    * @param index индекс реле в массиве
    * @return String
    */
-  String getRelayName(int8_t index);
+  String getRelayName(int16_t index);
 
   /**
    * @brief установка нового описания реле
@@ -269,7 +456,7 @@ public:
    * @param index индекс реле в массиве
    * @param _descr новое описание
    */
-  void setRelayDescription(int8_t index, String &_descr);
+  void setRelayDescription(int16_t index, String &_descr);
 
   /**
    * @brief получение текущего описания реле
@@ -277,7 +464,7 @@ public:
    * @param index индекс реле в массиве
    * @return String
    */
-  String getRelayDescription(int8_t index);
+  String getRelayDescription(int16_t index);
 
   /**
    * @brief установка нового имени файла для сохранения настроек
@@ -319,11 +506,17 @@ public:
 class shSwitchControl
 {
 private:
+  srContext *context; // данные экземпляра модуля
   uint32_t checkInterval = 30000;
   uint32_t checkTimer = 0;
+  uint8_t udpPacketBudget = 8;
+  uint16_t udpTimeBudget = 10;
+  uint8_t idleDelay = 1;
 
-  void receiveUdpPacket(int _size);
-  int8_t getRelayIndexByName(String &_res);
+  void receiveUdpPacket(srMessage &msg);
+  int16_t getRelayIndexByName(const String &_name);
+  int16_t getRelayIndexByHash(uint32_t _hash);
+  int16_t getRelayIndexByMessage(const srMessage &msg);
 
 public:
   /**
@@ -335,9 +528,9 @@ public:
   /**
    * @brief инициализация модуля выключателя
    *
-   * @param _switch_count количество удаленных реле
+   * @param _switch_count количество удаленных реле; если реле будет добавлено больше, таблица увеличивается в addRelay(); не более SR_MAX_RELAY_COUNT
    */
-  void init(uint8_t _switch_count);
+  void init(uint16_t _switch_count);
 
   /**
    * @brief добавление данных удаленного реле
@@ -390,7 +583,7 @@ public:
   void setBtnBeepData(uint16_t _freq, uint32_t _dur);
 
   /**
-   * @brief установка интервала проверки доступности связанных реле в сети в милисекундах; по умолчанию установлен интервал в 30 секунд
+   * @brief установка интервала проверки доступности связанных реле в сети в милисекундах; реле, не отвечавшие дольше этого интервала, опрашиваются по известному адресу, широковещательный запрос отправляется только для ненайденных реле; по умолчанию установлен интервал в 30 секунд
    *
    * @param _timer новое значение в милисекундах
    */
@@ -403,14 +596,42 @@ public:
    */
   uint32_t getCheckTimer();
 
+  /**
+   * @brief установка срока актуальности удаленного реле в милисекундах; если реле не отвечало дольше этого срока, оно считается ненайденным; по умолчанию - 90 секунд
+   *
+   * @param _ttl новое значение в милисекундах
+   */
+  void setRelayTtl(uint32_t _ttl);
+
+  /**
+   * @brief получение срока актуальности удаленного реле в милисекундах
+   *
+   * @return uint32_t
+   */
+  uint32_t getRelayTtl();
+
   /**
    * @brief запуск модуля
    *
-   * @param _udp ссылка на экземпляр **WiFiUDP**, который будет использоваться для работы модуля
+   * @param _udp ссылка на экземпляр **WiFiUDP**, который будет использоваться для работы модуля; один экземпляр могут использовать несколько модулей одной прошивки
    * @param _local_port порт для отправки/приема udp-пакетов; должен быть одинаковым для всех связанных модулей
    */
   void startDevice(WiFiUDP *_udp, uint16_t _local_port);
 
+  /**
+   * @brief установка группы multicast, в которую отправляются запросы поиска реле и команды для всех реле вместо широковещательного адреса; если адрес не задан (0.0.0.0) или на запросы в группу реле не отвечают, используется широковещательный адрес; группа должна быть одинаковой для всех связанных модулей
+   *
+   * @param _group адрес группы, 224.0.0.0 - 239.255.255.255
+   */
+  void setMulticastGroup(const IPAddress &_group);
+
+  /**
+   * @brief получение адреса группы multicast
+   *
+   * @return IPAddress
+   */
+  IPAddress getMulticastGroup();
+
   /**
    * @brief подключение Web-интерфейса
    *
@@ -424,6 +645,42 @@ public:
                           const String &_relay_config_page = "/relay_config",
                           const String &_wifi_config_page = "");
 
+  /**
+   * @brief настройка бюджета обработки входящих udp-пакетов за один вызов tick(); пакеты выбираются из очереди, пока она не опустеет или не будет исчерпан бюджет; по умолчанию - 8 пакетов и 10 мс
+   *
+   * @param _max_packets максимальное количество пакетов за один вызов
+   * @param _max_time максимальное время обработки пакетов в милисекундах
+   */
+  void setUdpBudget(uint8_t _max_packets, uint16_t _max_time);
+
+  /**
+   * @brief получение максимального количества пакетов, обрабатываемых за один вызов tick()
+   *
+   * @return uint8_t
+   */
+  uint8_t getUdpPacketBudget();
+
+  /**
+   * @brief получение максимального времени обработки пакетов за один вызов tick() в милисекундах
+   *
+   * @return uint16_t
+   */
+  uint16_t getUdpTimeBudget();
+
+  /**
+   * @brief установка паузы в конце tick(), если никакой работы не было; если работа была или пауза равна 0, вызывается только yield(); по умолчанию - 1 мс
+   *
+   * @param _delay пауза в милисекундах
+   */
+  void setIdleDelay(uint8_t _delay);
+
+  /**
+   * @brief получение размера паузы в конце tick() при отсутствии работы
+   *
+   * @return uint8_t
+   */
+  uint8_t getIdleDelay();
+
   /**
    * @brief обработка событий модуля
    *
@@ -435,14 +692,14 @@ public:
    *
    * @param index индекс реле в массиве
    */
-  void switchRelay(int8_t index);
+  void switchRelay(int16_t index);
 
   /**
    * @brief переключение состояния удаленного реле
    *
    * @param _name сетевое имя удаленного реле
    */
-  void switchRelay(String _name);
+  void switchRelay(const String &_name);
 
   /**
    * @brief установить состояние удаленного реле
@@ -450,7 +707,7 @@ public:
    * @param index индекс реле в массиве
    * @param state новое состояние реле; true - включено, иначе выключено;
    */
-  void setRelayState(int8_t index, bool state);
+  void setRelayState(int16_t index, bool state);
 
   /**
    * @brief установить состояние удаленного реле
@@ -458,7 +715,7 @@ public:
    * @param _name сетевое имя удаленного реле
    * @param state новое состояние реле; true - включено, иначе выключено;
    */
-  void setRelayState(String _name, bool state);
+  void setRelayState(const String &_name, bool state);
 
   /**
    * @brief установить состояние всех удаленных реле
@@ -474,6 +731,82 @@ public:
    */
   void findRelays();
 
+  /**
+   * @brief установка параметров повтора команд, оставшихся без подтверждения; повторы выполняются только для реле, поддерживающих бинарный протокол; интервал ожидания удваивается после каждого повтора; по умолчанию - 3 повтора, 100 мс
+   *
+   * @param _retries количество повторов
+   * @param _timeout время ожидания подтверждения до первого повтора в милисекундах
+   */
+  void setCommandRetryData(uint8_t _retries, uint16_t _timeout);
+
+  /**
+   * @brief получение количества повторов неподтвержденной команды
+   *
+   * @return uint8_t
+   */
+  uint8_t getCommandRetries();
+
+  /**
+   * @brief получение времени ожидания подтверждения команды до первого повтора
+   *
+   * @return uint16_t
+   */
+  uint16_t getCommandTimeout();
+
+  /**
+   * @brief получение количества команд, подтвержденных удаленным реле
+   *
+   * @param index индекс реле в массиве
+   * @return uint16_t
+   */
+  uint16_t getCommandSuccessCount(int16_t index);
+
+  /**
+   * @brief получение количества команд, оставшихся без подтверждения удаленным реле после всех повторов
+   *
+   * @param index индекс реле в массиве
+   * @return uint16_t
+   */
+  uint16_t getCommandFailedCount(int16_t index);
+
+  /**
+   * @brief включение/отключение подписки на уведомления об изменении состояния найденных удаленных реле; подписка продлевается при каждой проверке доступности реле; по умолчанию включена
+   *
+   * @param _state true - подписка включена, false - отключена
+   */
+  void setSubscribeState(bool _state);
+
+  /**
+   * @brief получение состояния подписки на уведомления об изменении состояния удаленных реле
+   *
+   * @return true - подписка включена
+   */
+  bool getSubscribeState();
+
+  /**
+   * @brief получение последнего известного состояния удаленного реле - из ответа на команду или из уведомления
+   *
+   * @param index индекс реле в массиве
+   * @return String "on" - включено; "off" - отключено; пустая строка, если состояние неизвестно
+   */
+  String getRelayState(int16_t index);
+
+  /**
+   * @brief получение дескриптора удаленного реле по его имени; дескриптор не меняется, пока не изменен список реле модуля, поэтому его достаточно получить один раз и затем использовать вместо имени в методах switchRelay(), setRelayState() и getState(), не создавая строк при каждом вызове
+   *
+   * @param _name сетевое имя удаленного реле
+   * @return RelayHandle дескриптор реле; -1 - реле не найдено
+   */
+  RelayHandle getRelayHandle(const char *_name);
+
+  /**
+   * @brief получение последнего известного состояния удаленного реле без создания строк
+   *
+   * @param _relay дескриптор или индекс реле в массиве
+   * @return SrRelayState stOn - включено; stOff - отключено; stUnknown - состояние неизвестно или реле не найдено
+   */
+  SrRelayState getState(RelayHandle _relay);
+
   /**
    * @brief установка описания модуля
    *
@@ -494,7 +827,7 @@ public:
    * @param index индекс реле в массиве
    * @param _name новое имя удаленного реле
    */
-  void setRelayName(int8_t index, String _name);
+  void setRelayName(int16_t index, String _name);
 
   /**
    * @brief получение текущего имени удаленного реле, связанного с кнопкой
@@ -502,7 +835,7 @@ public:
    * @param index индекс реле в массиве
    * @return String
    */
-  String getRelayName(int8_t index);
+  String getRelayName(int16_t index);
 
   /**
    * @brief установка нового имени файла для сохранения настроек
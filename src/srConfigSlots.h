@@ -0,0 +1,101 @@
+/**
+ * @file srConfigSlots.h
+ * @brief проверка слотов файла настроек и выбор слота с последней корректной версией;
+ *        только работа с байтами, без обращения к файловой системе, поэтому логика
+ *        проверяется и на компьютере (см. extras/tests)
+ *
+ */
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// файл настроек хранится в двух слотах (A/B), новая версия всегда пишется в слот, не содержащий
+// последнюю корректную версию; перед JSON в слоте записывается заголовок:
+// "#sr <номер версии> <crc32 в hex> <длина JSON>\n"
+static const uint8_t CONFIG_SLOT_COUNT = 2;
+static const uint8_t CONFIG_HEADER_SIZE = 40;
+
+// добавление байта к crc32; начальное значение - 0xFFFFFFFF, итоговое значение инвертируется
+inline uint32_t sr_crc32_update(uint32_t crc, uint8_t c)
+{
+  crc ^= c;
+  for (uint8_t i = 0; i < 8; i++)
+  {
+    crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+
+  return (crc);
+}
+
+// формирование заголовка слота; возвращает длину заголовка
+inline size_t sr_get_config_header(char *buf, uint32_t _seq, uint32_t _crc, size_t _len)
+{
+  snprintf(buf, CONFIG_HEADER_SIZE, "#sr %lu %08lx %u\n",
+           (unsigned long)_seq, (unsigned long)_crc, (unsigned)_len);
+
+  return (strlen(buf));
+}
+
+// проверка содержимого слота: заголовок, длина данных и контрольная сумма;
+// in - файл слота или любой другой источник с методами peek() и read(), size - размер слота;
+// при успехе возвращает номер версии и смещение JSON от начала слота
+template <typename Reader>
+bool sr_check_config_slot(Reader &in, size_t size, uint32_t &_seq, size_t &_offset)
+{
+  bool result = false;
+  if (in.peek() == '{')
+  {
+    // файл настроек старого формата, без заголовка; проверить его можно только при разборе
+    _seq = 0;
+    _offset = 0;
+    result = size > 0;
+  }
+  else
+  {
+    char header[CONFIG_HEADER_SIZE];
+    uint8_t i = 0;
+    int c = -1;
+    while (i < CONFIG_HEADER_SIZE - 1 && (c = in.read()) >= 0 && c != '\n')
+    {
+      header[i++] = c;
+    }
+    header[i] = 0;
+
+    unsigned long seq, crc;
+    unsigned len;
+    if (c == '\n' && sscanf(header, "#sr %lu %lx %u", &seq, &crc, &len) == 3)
+    {
+      _offset = i + 1;
+      // данные дописаны целиком и контрольная сумма совпадает
+      if (size == _offset + len)
+      {
+        uint32_t check = 0xFFFFFFFF;
+        while (len-- > 0 && (c = in.read()) >= 0)
+        {
+          check = sr_crc32_update(check, c);
+        }
+        _seq = seq;
+        result = c >= 0 && ~check == crc;
+      }
+    }
+  }
+
+  return (result);
+}
+
+// выбор корректного слота с самой свежей версией с учетом переполнения номера; -1 - корректных слотов нет
+inline int8_t sr_select_config_slot(const bool *_valid, const uint32_t *_seq)
+{
+  int8_t result = -1;
+  for (uint8_t i = 0; i < CONFIG_SLOT_COUNT; i++)
+  {
+    if (_valid[i] && (result < 0 || (int32_t)(_seq[i] - _seq[result]) > 0))
+    {
+      result = i;
+    }
+  }
+
+  return (result);
+}
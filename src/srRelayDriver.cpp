@@ -0,0 +1,233 @@
+#include <Arduino.h>
+#include "srRelayDrivers.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/gpio_reg.h>
+#endif
+
+// ---- srRelayDriver --------------------------
+
+void srRelayDriver::attachChannel(uint8_t _channel, bool _level)
+{
+  setChannel(_channel, _level);
+  commit();
+}
+
+void srRelayDriver::stageChannel(uint8_t _channel, bool _level)
+{
+  setChannel(_channel, _level);
+  staged = true;
+}
+
+void srRelayDriver::commitStaged()
+{
+  if (staged)
+  {
+    staged = false;
+    commit();
+  }
+}
+
+// ---- srGpioDriver ---------------------------
+
+void srGpioDriver::attachChannel(uint8_t _channel, bool _level)
+{
+  digitalWrite(_channel, _level);
+  pinMode(_channel, OUTPUT);
+}
+
+void srGpioDriver::setChannel(uint8_t _channel, bool _level)
+{
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (_channel < 16)
+  {
+    (_level) ? set_mask |= 1UL << _channel : clr_mask |= 1UL << _channel;
+    return;
+  }
+#else
+  if (_channel < 32)
+  {
+    (_level) ? set_mask |= 1UL << _channel : clr_mask |= 1UL << _channel;
+    return;
+  }
+#if defined(GPIO_OUT1_W1TS_REG)
+  if (_channel < 40)
+  {
+    (_level) ? set_mask1 |= 1UL << (_channel - 32) : clr_mask1 |= 1UL << (_channel - 32);
+    return;
+  }
+#endif
+#endif
+  digitalWrite(_channel, _level);
+}
+
+void srGpioDriver::commit()
+{
+#if defined(ARDUINO_ARCH_ESP8266)
+  if (set_mask || clr_mask)
+  {
+    GPOS = set_mask;
+    GPOC = clr_mask;
+  }
+#else
+  if (set_mask || clr_mask)
+  {
+    REG_WRITE(GPIO_OUT_W1TS_REG, set_mask);
+    REG_WRITE(GPIO_OUT_W1TC_REG, clr_mask);
+  }
+#if defined(GPIO_OUT1_W1TS_REG)
+  if (set_mask1 || clr_mask1)
+  {
+    REG_WRITE(GPIO_OUT1_W1TS_REG, set_mask1);
+    REG_WRITE(GPIO_OUT1_W1TC_REG, clr_mask1);
+  }
+#endif
+  set_mask1 = 0;
+  clr_mask1 = 0;
+#endif
+  set_mask = 0;
+  clr_mask = 0;
+}
+
+// номер пина проверяется ядром, ограничения на количество каналов нет
+uint8_t srGpioDriver::getChannelCount() { return (255); }
+
+// ---- srBufferedRelayDriver ------------------
+
+srBufferedRelayDriver::srBufferedRelayDriver(uint8_t _channel_count, uint8_t _init_value)
+{
+  channel_count = (_channel_count > SR_MAX_DRIVER_CHANNELS) ? SR_MAX_DRIVER_CHANNELS : _channel_count;
+  memset(buf, _init_value, sizeof(buf));
+}
+
+void srBufferedRelayDriver::attachChannel(uint8_t _channel, bool _level)
+{
+  if (!started)
+  {
+    beginOutputs();
+    started = true;
+  }
+  setChannel(_channel, _level);
+  // начальный уровень выставляем сразу, даже если он совпадает с буфером
+  writeOutputs();
+  dirty = false;
+}
+
+void srBufferedRelayDriver::setChannel(uint8_t _channel, bool _level)
+{
+  if (_channel >= channel_count)
+  {
+    return;
+  }
+
+  uint8_t bit = 1 << (_channel & 7);
+  uint8_t value = (_level) ? buf[_channel >> 3] | bit : buf[_channel >> 3] & ~bit;
+  if (value != buf[_channel >> 3])
+  {
+    buf[_channel >> 3] = value;
+    dirty = true;
+  }
+}
+
+void srBufferedRelayDriver::commit()
+{
+  if (dirty)
+  {
+    writeOutputs();
+    dirty = false;
+  }
+}
+
+uint8_t srBufferedRelayDriver::getChannelCount() { return (channel_count); }
+
+// ---- sr74hc595Driver ------------------------
+
+sr74hc595Driver::sr74hc595Driver(uint8_t _data_pin,
+                                 uint8_t _clock_pin,
+                                 uint8_t _latch_pin,
+                                 uint8_t _chip_count) : srBufferedRelayDriver(_chip_count * 8, 0x00)
+{
+  data_pin = _data_pin;
+  clock_pin = _clock_pin;
+  latch_pin = _latch_pin;
+  chip_count = channel_count / 8;
+}
+
+void sr74hc595Driver::beginOutputs()
+{
+  digitalWrite(latch_pin, LOW);
+  pinMode(latch_pin, OUTPUT);
+  pinMode(clock_pin, OUTPUT);
+  pinMode(data_pin, OUTPUT);
+}
+
+void sr74hc595Driver::writeOutputs()
+{
+  // первым выдвигается байт последнего регистра цепочки, старшим битом вперед;
+  // на выходы все регистры переносят данные одновременно по фронту ST_CP
+  digitalWrite(latch_pin, LOW);
+  for (int8_t i = chip_count - 1; i >= 0; i--)
+  {
+    shiftOut(data_pin, clock_pin, MSBFIRST, buf[i]);
+  }
+  digitalWrite(latch_pin, HIGH);
+}
+
+// ---- srPcf8574Driver ------------------------
+
+// после включения питания на всех выходах PCF8574 высокий уровень, поэтому и буфер заполняется единицами
+srPcf8574Driver::srPcf8574Driver(uint8_t _address, TwoWire *_wire) : srBufferedRelayDriver(8, 0xFF)
+{
+  wire = _wire;
+  address = _address;
+}
+
+void srPcf8574Driver::writeOutputs()
+{
+  wire->beginTransmission(address);
+  wire->write(buf[0]);
+  wire->endTransmission();
+}
+
+// ---- srMcp23017Driver -----------------------
+
+// регистры MCP23017 при IOCON.BANK = 0 (значение после включения питания)
+#define MCP_IODIRA 0x00
+#define MCP_OLATA 0x14
+
+srMcp23017Driver::srMcp23017Driver(uint8_t _address, TwoWire *_wire) : srBufferedRelayDriver(16, 0x00)
+{
+  wire = _wire;
+  address = _address;
+}
+
+void srMcp23017Driver::writeRegisters(uint8_t _reg, const uint8_t *_data)
+{
+  // регистры портов A и B идут подряд, а адрес регистра после каждого байта увеличивается,
+  // поэтому оба порта записываются одной транзакцией
+  wire->beginTransmission(address);
+  wire->write(_reg);
+  wire->write(_data[0]);
+  wire->write(_data[1]);
+  wire->endTransmission();
+}
+
+void srMcp23017Driver::writeOutputs()
+{
+  writeRegisters(MCP_OLATA, buf);
+}
+
+void srMcp23017Driver::attachChannel(uint8_t _channel, bool _level)
+{
+  if (_channel >= channel_count)
+  {
+    return;
+  }
+
+  // сначала выставляем уровень в защелке, затем переводим пин в режим выхода,
+  // чтобы при подключении реле не срабатывало
+  setChannel(_channel, _level);
+  writeOutputs();
+  dirty = false;
+  iodir[_channel >> 3] &= ~(1 << (_channel & 7));
+  writeRegisters(MCP_IODIRA, iodir);
+}
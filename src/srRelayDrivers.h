@@ -0,0 +1,192 @@
+/**
+ * @file srRelayDrivers.h
+ * @brief драйверы выходов реле: пины модуля, сдвиговые регистры 74HC595 и расширители портов
+ *        PCF8574/MCP23017 на шине I2C;
+ *        изменения состояния реле накапливаются драйвером и переносятся на выходы одной записью
+ *        в регистры или одной транзакцией на шине при вызове commit()
+ *
+ */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+// ==== srRelayDriver ===============================
+
+/**
+ * @brief базовый класс драйвера выходов реле; номер канала драйвера задается при добавлении реле
+ *        вместо номера пина
+ *
+ */
+class srRelayDriver
+{
+private:
+  bool staged = false; // после последнего commitStaged() были вызовы stageChannel()
+
+public:
+  virtual ~srRelayDriver() {}
+
+  // подготовка канала к работе и установка на нем начального уровня; выполняется сразу, без ожидания commit()
+  virtual void attachChannel(uint8_t _channel, bool _level);
+
+  // установка уровня канала; изменение переносится на выход при вызове commit()
+  virtual void setChannel(uint8_t _channel, bool _level) = 0;
+
+  // перенос накопленных изменений на выходы; если изменений не было, ничего не делает
+  virtual void commit() = 0;
+
+  // количество каналов драйвера
+  virtual uint8_t getChannelCount() = 0;
+
+  // установка уровня канала модулем реле; изменения всех реле, вызванные одной командой,
+  // собираются так, чтобы затем commitStaged() вызвал commit() драйвера только один раз
+  void stageChannel(uint8_t _channel, bool _level);
+
+  // вызов commit(), если после прошлого вызова были изменения через stageChannel(); повторные
+  // вызовы для уже записанного драйвера ничего не делают
+  void commitStaged();
+};
+
+// ==== srGpioDriver ================================
+
+/**
+ * @brief пины самого модуля; уровни собираются в маски и выставляются записью в регистры
+ *        set/clear (W1TS/W1TC), поэтому все реле переключаются одновременно; пины, для которых
+ *        такой записи нет, переключаются через digitalWrite() сразу
+ *
+ */
+class srGpioDriver : public srRelayDriver
+{
+private:
+  uint32_t set_mask = 0;
+  uint32_t clr_mask = 0;
+#if defined(ARDUINO_ARCH_ESP32)
+  uint32_t set_mask1 = 0;
+  uint32_t clr_mask1 = 0;
+#endif
+
+public:
+  void attachChannel(uint8_t _channel, bool _level);
+  void setChannel(uint8_t _channel, bool _level);
+  void commit();
+  uint8_t getChannelCount();
+};
+
+// ==== srBufferedRelayDriver =======================
+
+// максимальное количество каналов драйвера с буфером выходов
+#define SR_MAX_DRIVER_CHANNELS 64
+
+/**
+ * @brief основа драйверов, управляющих выходами через шину; уровни каналов хранятся в буфере,
+ *        который целиком переносится на выходы в commit(), если с прошлой записи он изменился
+ *
+ */
+class srBufferedRelayDriver : public srRelayDriver
+{
+protected:
+  uint8_t buf[SR_MAX_DRIVER_CHANNELS / 8]; // уровни каналов, по биту на канал
+  uint8_t channel_count;
+  bool dirty = false;   // буфер изменен, но еще не перенесен на выходы
+  bool started = false; // выполнена подготовка устройства к работе
+
+  srBufferedRelayDriver(uint8_t _channel_count, uint8_t _init_value);
+
+  // подготовка устройства к работе; вызывается один раз перед подключением первого канала
+  virtual void beginOutputs() {}
+
+  // перенос буфера на выходы
+  virtual void writeOutputs() = 0;
+
+public:
+  void attachChannel(uint8_t _channel, bool _level);
+  void setChannel(uint8_t _channel, bool _level);
+  void commit();
+  uint8_t getChannelCount();
+};
+
+// ==== sr74hc595Driver =============================
+
+/**
+ * @brief цепочка сдвиговых регистров 74HC595; канал 0 - выход Q0 регистра, ближайшего к модулю
+ *
+ */
+class sr74hc595Driver : public srBufferedRelayDriver
+{
+private:
+  uint8_t data_pin;
+  uint8_t clock_pin;
+  uint8_t latch_pin;
+  uint8_t chip_count;
+
+protected:
+  void beginOutputs();
+  void writeOutputs();
+
+public:
+  /**
+   * @brief конструктор драйвера
+   *
+   * @param _data_pin пин, подключенный к входу DS первого регистра
+   * @param _clock_pin пин, подключенный к входам SH_CP регистров
+   * @param _latch_pin пин, подключенный к входам ST_CP регистров
+   * @param _chip_count количество регистров в цепочке, не более 8
+   */
+  sr74hc595Driver(uint8_t _data_pin, uint8_t _clock_pin, uint8_t _latch_pin, uint8_t _chip_count = 1);
+};
+
+// ==== srPcf8574Driver =============================
+
+/**
+ * @brief расширитель портов PCF8574/PCF8574A, 8 каналов; шина I2C должна быть инициализирована
+ *        в скетче вызовом Wire.begin()
+ *
+ */
+class srPcf8574Driver : public srBufferedRelayDriver
+{
+private:
+  TwoWire *wire;
+  uint8_t address;
+
+protected:
+  void writeOutputs();
+
+public:
+  /**
+   * @brief конструктор драйвера
+   *
+   * @param _address адрес микросхемы на шине I2C
+   * @param _wire шина I2C
+   */
+  srPcf8574Driver(uint8_t _address = 0x20, TwoWire *_wire = &Wire);
+};
+
+// ==== srMcp23017Driver ============================
+
+/**
+ * @brief расширитель портов MCP23017, 16 каналов: 0..7 - порт A, 8..15 - порт B; шина I2C должна
+ *        быть инициализирована в скетче вызовом Wire.begin()
+ *
+ */
+class srMcp23017Driver : public srBufferedRelayDriver
+{
+private:
+  TwoWire *wire;
+  uint8_t address;
+  uint8_t iodir[2] = {0xFF, 0xFF}; // направление пинов портов A и B; 1 - вход
+
+  void writeRegisters(uint8_t _reg, const uint8_t *_data);
+
+protected:
+  void writeOutputs();
+
+public:
+  /**
+   * @brief конструктор драйвера
+   *
+   * @param _address адрес микросхемы на шине I2C
+   * @param _wire шина I2C
+   */
+  srMcp23017Driver(uint8_t _address = 0x20, TwoWire *_wire = &Wire);
+
+  void attachChannel(uint8_t _channel, bool _level);
+};